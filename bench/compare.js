@@ -0,0 +1,38 @@
+// Prints reports of bench/run.sh side by side, every column relative to the
+// first file: native against wasm, or one commit against another.
+//   node compare.js base.json other.json ...
+const fs = require("fs");
+
+const files = process.argv.slice(2);
+if (files.length === 0) {
+    console.error("Usage: node compare.js base.json [other.json ...]");
+    process.exit(1);
+}
+const reports = files.map(f => JSON.parse(fs.readFileSync(f, "utf8")));
+const names = [];
+for (const report of reports)
+    for (const r of report.results)
+        if (!names.includes(r.name))
+            names.push(r.name);
+
+const label = report => `${report.target}@${report.commit}`;
+let header = "benchmark".padEnd(24);
+for (const report of reports)
+    header += label(report).padStart(28);
+console.log(header);
+console.log(" ".repeat(24) + "median ns/op (x base)".padStart(28));
+for (const name of names) {
+    const base = reports[0].results.find(r => r.name === name);
+    let line = name.padEnd(24);
+    for (const report of reports) {
+        const r = report.results.find(r => r.name === name);
+        let cell = "-";
+        if (r) {
+            cell = r.median_ns.toFixed(2);
+            if (base && report !== reports[0])
+                cell += ` (${(r.median_ns / base.median_ns).toFixed(2)}x)`;
+        }
+        line += cell.padStart(28);
+    }
+    console.log(line);
+}
@@ -0,0 +1,129 @@
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#include "harness.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const BenchOptions BENCH_DEFAULTS = {200.0, 20.0, 30, NULL};
+
+typedef struct BenchResult{
+    char name[64];
+    double ops_per_iteration;
+    uint64_t iterations; // Per sample
+    double median_ns;    // All times per operation
+    double p95_ns;
+    double mean_ns;
+    double min_ns;
+}BenchResult;
+
+static struct{
+    BenchOptions options;
+    const char *target;
+    const char *commit;
+    BenchResult *results;
+    int count;
+    int capacity;
+}report;
+
+double bench_now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b){
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank percentile of sorted values
+static double percentile(const double *sorted, int n, double p){
+    int rank = (int)(p / 100.0 * n + 0.999999);
+    rank = rank < 1 ? 1 : rank > n ? n : rank;
+    return sorted[rank - 1];
+}
+
+static double time_run(BenchFn fn, void *ctx, uint64_t iterations){
+    double start = bench_now_ns();
+    fn(ctx, iterations);
+    return bench_now_ns() - start;
+}
+
+void bench_begin(const BenchOptions *options, const char *target, const char *commit){
+    report.options = options ? *options : BENCH_DEFAULTS;
+    report.target = target;
+    report.commit = commit;
+    report.count = 0;
+}
+
+void bench_run(const char *name, BenchFn fn, void *ctx, double ops_per_iteration){
+    const BenchOptions *o = &report.options;
+    if (o->filter && !strstr(name, o->filter))
+        return;
+
+    // Calibrate, doubling the iterations also warms up
+    uint64_t iterations = 1;
+    double ns = time_run(fn, ctx, iterations);
+    while (ns < o->sample_ms * 1e6 && iterations < (1ull << 40)){
+        iterations *= 2;
+        ns = time_run(fn, ctx, iterations);
+    }
+    double warm_until = bench_now_ns() + o->warmup_ms * 1e6;
+    while (bench_now_ns() < warm_until)
+        time_run(fn, ctx, iterations);
+
+    int n = o->samples > 0 ? o->samples : 1;
+    double *times = malloc(n * sizeof(double));
+    if (!times){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    double ops = iterations * ops_per_iteration;
+    double sum = 0;
+    for (int i = 0; i < n; i++){
+        times[i] = time_run(fn, ctx, iterations) / ops;
+        sum += times[i];
+    }
+    qsort(times, n, sizeof(double), compare_doubles);
+
+    if (report.count == report.capacity){
+        report.capacity = report.capacity ? 2 * report.capacity : 16;
+        report.results = realloc(report.results, report.capacity * sizeof(BenchResult));
+        if (!report.results){
+            fprintf(stderr, "Error: out of memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    BenchResult *r = &report.results[report.count++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->ops_per_iteration = ops_per_iteration;
+    r->iterations = iterations;
+    r->median_ns = percentile(times, n, 50);
+    r->p95_ns = percentile(times, n, 95);
+    r->mean_ns = sum / n;
+    r->min_ns = times[0];
+    free(times);
+    fprintf(stderr, "%-24s %12.2f ns/op  p95 %12.2f  %14.1f ops/s\n", r->name,
+            r->median_ns, r->p95_ns, 1e9 / r->median_ns);
+}
+
+void bench_end(FILE *out){
+    fprintf(out, "{\"target\": \"%s\", \"commit\": \"%s\", \"samples\": %d, "
+                 "\"results\": [", report.target, report.commit,
+            report.options.samples);
+    for (int i = 0; i < report.count; i++){
+        const BenchResult *r = &report.results[i];
+        fprintf(out, "%s\n  {\"name\": \"%s\", \"ops_per_iteration\": %.0f, "
+                     "\"iterations\": %llu, \"median_ns\": %.3f, \"p95_ns\": %.3f, "
+                     "\"mean_ns\": %.3f, \"min_ns\": %.3f, \"ops_per_sec\": %.1f}",
+                i ? "," : "", r->name, r->ops_per_iteration,
+                (unsigned long long)r->iterations, r->median_ns, r->p95_ns,
+                r->mean_ns, r->min_ns, 1e9 / r->median_ns);
+    }
+    fprintf(out, "\n]}\n");
+    free(report.results);
+    report.results = NULL;
+    report.count = 0;
+    report.capacity = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Micro benchmark harness shared by the native and the WebAssembly build.
+ * A benchmark is a function that runs its operation a given number of
+ * times. bench_run calibrates that count until one run takes sample_ms,
+ * warms up for warmup_ms (JIT tiers and caches) and then times `samples`
+ * runs. The results are reported per operation: median, p95, mean, min and
+ * operations per second from the median.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*BenchFn)(void *ctx, uint64_t iterations);
+
+typedef struct BenchOptions{
+    double warmup_ms;
+    double sample_ms;
+    int samples;
+    const char *filter; // Only names containing it run, NULL for all
+}BenchOptions;
+
+extern const BenchOptions BENCH_DEFAULTS;
+
+// Starts a report, target and commit are copied into the JSON
+void bench_begin(const BenchOptions *options, const char *target, const char *commit);
+// Times fn, each iteration is ops_per_iteration operations
+void bench_run(const char *name, BenchFn fn, void *ctx, double ops_per_iteration);
+// Writes the JSON report to out and frees the results
+void bench_end(FILE *out);
+
+// Nanoseconds on a monotonic clock
+double bench_now_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,260 @@
+#include "fib.h"
+#include "harness.h"
+#include "hit_counts.h"
+#include "sampler.h"
+extern "C" {
+#include "exact.h"
+#include "revised.h"
+#include "simplex.h"
+#include "value.h"
+}
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/*
+ * Benchmarks of fib, the Fractional ops and the simplex of linear_programming
+ * and the Monte Carlo sampling loop of the viewer, built natively and with Emscripten from
+ * the same sources (see run.sh):
+ *
+ *   bench [--target name] [--commit id] [--out file] [--filter text]
+ *         [--samples n] [--sample-ms ms] [--warmup-ms ms]
+ *
+ * Progress goes to stderr, the JSON report to --out or stdout.
+ */
+
+// Results are folded into this so no benchmark is optimized away
+static volatile uint64_t sink;
+
+static void benchFibRecursive(void *, uint64_t iterations) {
+  for (uint64_t i = 0; i < iterations; i++)
+    sink += fib_recursive(20);
+}
+
+static void benchFibDynamic(void *, uint64_t iterations) {
+  for (uint64_t i = 0; i < iterations; i++)
+    sink += fib_dynamic_programming(90);
+}
+
+static void benchFibBig(void *, uint64_t iterations) {
+  for (uint64_t i = 0; i < iterations; i++)
+    sink += fib_big(100000)[0];
+}
+
+static void benchFibMod(void *, uint64_t iterations) {
+  for (uint64_t i = 0; i < iterations; i++)
+    sink += fib_mod(1000000000000ULL + i, 1000000007ULL);
+}
+
+// Operands of the Fractional benchmarks, small terms like a tableau's
+struct Fractions {
+  static const size_t COUNT = 1024;
+  std::vector<Fractional> a, b;
+
+  Fractions() : a(COUNT), b(COUNT) {
+    uint32_t x = 12345;
+    for (size_t i = 0; i < COUNT; i++) {
+      x = x * 1664525 + 1013904223;
+      a[i] = {static_cast<int64_t>(x >> 22) - 512, static_cast<int64_t>(x >> 8 & 1023) + 1,
+              nullptr};
+      x = x * 1664525 + 1013904223;
+      b[i] = {static_cast<int64_t>(x >> 22 | 1), static_cast<int64_t>(x >> 8 & 1023) + 1,
+              nullptr};
+    }
+  }
+};
+
+template <Fractional (*Op)(const Fractional *, const Fractional *)>
+static void benchFraction(void *ctx, uint64_t iterations) {
+  const Fractions &f = *static_cast<const Fractions *>(ctx);
+  for (uint64_t i = 0; i < iterations; i++)
+    for (size_t j = 0; j < Fractions::COUNT; j++)
+      sink += Op(&f.a[j], &f.b[j]).numerator;
+}
+
+// Fills and solves a random dense n x n LP with <= rows, like dense_n of
+// linear_programming/simplex_bench.c
+template <int N>
+static void benchSimplexDense(void *, uint64_t iterations) {
+  std::vector<RowType> types(N, ROW_LE);
+  for (uint64_t i = 0; i < iterations; i++) {
+    Tableu *t = tableu_create(N, N, types.data());
+    if (!t) {
+      fprintf(stderr, "Error: out of memory.\n");
+      exit(EXIT_FAILURE);
+    }
+    uint32_t x = 12345;
+    for (int r = 0; r < N; r++) {
+      for (int c = 0; c < N; c++) {
+        x = x * 1664525 + 1013904223;
+        tableu_set_a(t, r, c, 1 + (x >> 8) % 100);
+      }
+      x = x * 1664525 + 1013904223;
+      tableu_set_b(t, r, 1000 + (x >> 8) % 1000);
+    }
+    for (int c = 0; c < N; c++) {
+      x = x * 1664525 + 1013904223;
+      tableu_set_z(t, c, -(1.0 + (x >> 8) % 50));
+    }
+    sink += simplex_solve(t, nullptr) + t->iterations;
+    tableu_destroy(t);
+  }
+}
+
+// The same with small integer data, solved exactly
+template <int N>
+static void benchSimplexExact(void *, uint64_t iterations) {
+  std::vector<RowType> types(N, ROW_LE);
+  for (uint64_t i = 0; i < iterations; i++) {
+    ExactTableu *t = exact_create(N, N, types.data());
+    if (!t) {
+      fprintf(stderr, "Error: out of memory.\n");
+      exit(EXIT_FAILURE);
+    }
+    uint32_t x = 12345;
+    for (int r = 0; r < N; r++) {
+      for (int c = 0; c < N; c++) {
+        x = x * 1664525 + 1013904223;
+        exact_set_a(t, r, c, {static_cast<int64_t>(1 + (x >> 8) % 9), 1, nullptr});
+      }
+      x = x * 1664525 + 1013904223;
+      exact_set_b(t, r, {static_cast<int64_t>(10 + (x >> 8) % 90), 1, nullptr});
+    }
+    for (int c = 0; c < N; c++) {
+      x = x * 1664525 + 1013904223;
+      exact_set_z(t, c, {-static_cast<int64_t>(1 + (x >> 8) % 9), 2, nullptr});
+    }
+    sink += exact_solve(t, nullptr) + t->iterations;
+    exact_destroy(t);
+  }
+}
+
+// Fills and solves the sparse LP random_m of
+// linear_programming/sparse_bench.c with the revised simplex
+template <int M>
+static void benchSimplexSparse(void *, uint64_t iterations) {
+  std::vector<RowType> types(M, ROW_LE);
+  for (uint64_t i = 0; i < iterations; i++) {
+    SparseLP *lp = sparse_create(M, 2 * M, types.data(), 8 * M);
+    if (!lp) {
+      fprintf(stderr, "Error: out of memory.\n");
+      exit(EXIT_FAILURE);
+    }
+    uint32_t x = 12345;
+    for (int r = 0; r < M; r++) {
+      x = x * 1664525 + 1013904223;
+      sparse_set_b(lp, r, 100 + (x >> 8) % 900);
+    }
+    for (int c = 0; c < 2 * M; c++) {
+      for (int k = 0; k < 4; k++) {
+        x = x * 1664525 + 1013904223;
+        int r = (x >> 8) % M;
+        x = x * 1664525 + 1013904223;
+        sparse_add(lp, r, c, 1 + (x >> 8) % 9);
+      }
+      x = x * 1664525 + 1013904223;
+      sparse_set_z(lp, c, -(1.0 + (x >> 8) % 20));
+    }
+    sink += sparse_solve(lp, nullptr) + lp->iterations;
+    sparse_destroy(lp);
+  }
+}
+
+// One frame of the viewer's sampling loop: a batch on the 400x400 grid,
+// optionally accumulated into the hit counts
+struct Sampling {
+  static const size_t BATCH = 1 << 16;
+  HitCounts hits;
+  std::vector<uint32_t> samples;
+  uint64_t first = 0;
+
+  Sampling() : samples(BATCH) { hits.resize(400, 400); }
+};
+
+template <bool Accumulate>
+static void benchSampling(void *ctx, uint64_t iterations) {
+  Sampling &s = *static_cast<Sampling *>(ctx);
+  const SampleGrid grid = s.hits.grid();
+  for (uint64_t i = 0; i < iterations; i++) {
+    sink += sampleBatch(SAMPLE_RANDOM, 1, s.first, Sampling::BATCH, grid,
+                        s.samples.data());
+    s.first += Sampling::BATCH;
+    if (Accumulate)
+      s.hits.add(s.samples);
+  }
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [--target name] [--commit id] [--out file] "
+          "[--filter text]\n"
+          "          [--samples n] [--sample-ms ms] [--warmup-ms ms]\n",
+          name);
+}
+
+int main(int argc, char *argv[]) {
+  BenchOptions options = BENCH_DEFAULTS;
+#ifdef __EMSCRIPTEN__
+  const char *target = "wasm";
+#else
+  const char *target = "native";
+#endif
+  const char *commit = "unknown";
+  const char *out = nullptr;
+  for (int i = 1; i < argc; i++) {
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!value) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    if (strcmp(argv[i], "--target") == 0) {
+      target = value;
+    } else if (strcmp(argv[i], "--commit") == 0) {
+      commit = value;
+    } else if (strcmp(argv[i], "--out") == 0) {
+      out = value;
+    } else if (strcmp(argv[i], "--filter") == 0) {
+      options.filter = value;
+    } else if (strcmp(argv[i], "--samples") == 0) {
+      options.samples = atoi(value);
+    } else if (strcmp(argv[i], "--sample-ms") == 0) {
+      options.sample_ms = strtod(value, nullptr);
+    } else if (strcmp(argv[i], "--warmup-ms") == 0) {
+      options.warmup_ms = strtod(value, nullptr);
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    i++;
+  }
+
+  Fractions fractions;
+  Sampling sampling;
+  bench_begin(&options, target, commit);
+  bench_run("fib_recursive_20", benchFibRecursive, nullptr, 1);
+  bench_run("fib_dynamic_90", benchFibDynamic, nullptr, 1);
+  bench_run("fib_big_100000", benchFibBig, nullptr, 1);
+  bench_run("fib_mod", benchFibMod, nullptr, 1);
+  bench_run("fraction_add", benchFraction<fadd>, &fractions, Fractions::COUNT);
+  bench_run("fraction_sub", benchFraction<fsub>, &fractions, Fractions::COUNT);
+  bench_run("fraction_mul", benchFraction<fmul>, &fractions, Fractions::COUNT);
+  bench_run("fraction_div", benchFraction<fdiv>, &fractions, Fractions::COUNT);
+  bench_run("simplex_dense_50", benchSimplexDense<50>, nullptr, 1);
+  bench_run("simplex_dense_150", benchSimplexDense<150>, nullptr, 1);
+  bench_run("simplex_exact_40", benchSimplexExact<40>, nullptr, 1);
+  bench_run("simplex_sparse_200", benchSimplexSparse<200>, nullptr, 1);
+  bench_run("mc_sample", benchSampling<false>, &sampling, Sampling::BATCH);
+  bench_run("mc_sample_accumulate", benchSampling<true>, &sampling,
+            Sampling::BATCH);
+
+  FILE *f = out ? fopen(out, "w") : stdout;
+  if (!f) {
+    fprintf(stderr, "Error: could not write %s\n", out);
+    return EXIT_FAILURE;
+  }
+  bench_end(f);
+  if (out)
+    fclose(f);
+  return 0;
+}
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Builds the benchmark natively and, if emcc is on the PATH, as WebAssembly
+# run under node, and writes one JSON report per target to results/:
+#
+#   bench/run.sh [bench options]    e.g. --filter fib --samples 50
+#   node bench/compare.js bench/results/<commit>-*.json
+#
+# CC, CXX, EMCC and NODE pick the tools.
+set -e
+cd "$(dirname "$0")"
+CC=${CC:-cc}
+CXX=${CXX:-c++}
+EMCC=${EMCC:-emcc}
+NODE=${NODE:-node}
+COMMIT=$(git rev-parse --short HEAD 2>/dev/null || echo unknown)
+BUILD=build
+mkdir -p "$BUILD" results
+
+C_SOURCES="../fib/fib.c ../linear_programming/value.c ../linear_programming/simplex.c
+           ../linear_programming/simplex_data.c ../linear_programming/exact.c
+           ../linear_programming/revised.c harness.c"
+CXX_SOURCES="main.cpp ../monteCarloPi/sampler.cpp ../monteCarloPi/hit_counts.cpp"
+INCLUDES="-I. -I../fib -I../linear_programming -I../monteCarloPi"
+# -ffp-contract=off like mcp_core, so every target samples the same points
+CFLAGS="-O2 -DVALUE_NO_MAIN -ffp-contract=off $INCLUDES"
+
+build() { # compiler for C, compiler for C++, output, extra flags
+    objs=""
+    for src in $C_SOURCES; do
+        obj="$BUILD/$(basename "$src" .c)-$3.o"
+        $1 -std=c11 $CFLAGS $4 -c "$src" -o "$obj"
+        objs="$objs $obj"
+    done
+    $2 -std=c++17 $CFLAGS $4 $CXX_SOURCES $objs -o "$BUILD/$3" $5
+}
+
+build "$CC" "$CXX" bench_native "" ""
+"$BUILD/bench_native" --commit "$COMMIT" --out "results/$COMMIT-native.json" "$@"
+
+if command -v "$EMCC" >/dev/null 2>&1; then
+    build "$EMCC" "$EMCC" bench_wasm.js "-msimd128" \
+        "-s ALLOW_MEMORY_GROWTH=1 -s NODERAWFS=1 -s EXIT_RUNTIME=1"
+    "$NODE" "$BUILD/bench_wasm.js" --commit "$COMMIT" \
+        --out "results/$COMMIT-wasm.json" "$@"
+else
+    echo "$EMCC not found, skipping the WebAssembly build" >&2
+fi
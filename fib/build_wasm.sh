@@ -0,0 +1,29 @@
+#!/bin/sh
+# Builds fib.wasm without emcc, from clang and wasm-ld, against the
+# freestanding runtime in wasm/. The module has the interface of the emcc
+# build at the top of fib.c: every export of fib.h, no imports and a fixed
+# 64 MB memory.
+#
+#   fib/build_wasm.sh
+#
+# CLANG and WASM_LD pick the tools.
+set -e
+cd "$(dirname "$0")"
+CLANG=${CLANG:-clang}
+WASM_LD=${WASM_LD:-wasm-ld}
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+CFLAGS="--target=wasm32 -O3 -ffreestanding -nostdlib -Iwasm"
+EXPORTS="fib_recursive fib_dynamic_programming fib_table fib_memoized fib_big
+         fib_big_length fib_mod fib_alloc fib_free fib_batch fib_mod_batch"
+
+"$CLANG" $CFLAGS -c fib.c -o "$BUILD/fib.o"
+"$CLANG" $CFLAGS -c wasm/runtime.c -o "$BUILD/runtime.o"
+flags=""
+for name in $EXPORTS; do
+    flags="$flags --export=$name"
+done
+"$WASM_LD" --no-entry $flags --initial-memory=67108864 --max-memory=67108864 \
+    -z stack-size=65536 --strip-all --gc-sections \
+    "$BUILD/fib.o" "$BUILD/runtime.o" -o fib.wasm
@@ -1,6 +1,17 @@
+// Build: emcc fib.c -O3 --no-entry -s STANDALONE_WASM -s INITIAL_MEMORY=64MB -o fib.wasm
+// Without emcc: build_wasm.sh, clang and wasm-ld with the runtime in wasm/.
+// The committed fib.wasm comes from build_wasm.sh.
+// The module has no imports and a fixed memory, so views on it stay valid.
+#ifdef __EMSCRIPTEN__
 #include "emscripten.h"
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+#include "fib.h"
+#include <stdlib.h>
+#include <string.h>
 
-EMSCRIPTEN_KEEPALIVE 
+EMSCRIPTEN_KEEPALIVE
 long fib_recursive(int n) {
     if (n <= 0)
         return 0;
@@ -10,7 +21,7 @@ long fib_recursive(int n) {
       return fib_recursive(n-2)+fib_recursive(n-1);
 }
 
-EMSCRIPTEN_KEEPALIVE 
+EMSCRIPTEN_KEEPALIVE
 long fib_dynamic_programming(int n) {
     if(n <= 0)
         return 0;
@@ -22,4 +33,436 @@ long fib_dynamic_programming(int n) {
         f1 = temp;
     }
     return f1;
-}
\ No newline at end of file
+}
+
+// F(0) .. F(92), every Fibonacci number that fits in an int64_t. Plain
+// static data, the module does no work for it at startup.
+#define FIB_INT64_MAX_N 92
+static const int64_t FIB_TABLE[FIB_INT64_MAX_N + 1] = {
+    0, 1, 1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, 233, 377, 610, 987, 1597,
+    2584, 4181, 6765, 10946, 17711, 28657, 46368, 75025, 121393, 196418, 317811,
+    514229, 832040, 1346269, 2178309, 3524578, 5702887, 9227465, 14930352,
+    24157817, 39088169, 63245986, 102334155, 165580141, 267914296, 433494437,
+    701408733, 1134903170, 1836311903, 2971215073LL, 4807526976LL, 7778742049LL,
+    12586269025LL, 20365011074LL, 32951280099LL, 53316291173LL, 86267571272LL,
+    139583862445LL, 225851433717LL, 365435296162LL, 591286729879LL,
+    956722026041LL, 1548008755920LL, 2504730781961LL, 4052739537881LL,
+    6557470319842LL, 10610209857723LL, 17167680177565LL, 27777890035288LL,
+    44945570212853LL, 72723460248141LL, 117669030460994LL, 190392490709135LL,
+    308061521170129LL, 498454011879264LL, 806515533049393LL, 1304969544928657LL,
+    2111485077978050LL, 3416454622906707LL, 5527939700884757LL,
+    8944394323791464LL, 14472334024676221LL, 23416728348467685LL,
+    37889062373143906LL, 61305790721611591LL, 99194853094755497LL,
+    160500643816367088LL, 259695496911122585LL, 420196140727489673LL,
+    679891637638612258LL, 1100087778366101931LL, 1779979416004714189LL,
+    2880067194370816120LL, 4660046610375530309LL, 7540113804746346429LL,
+};
+
+// F(n) from the table, -1 for n outside 0..92. Branch free: an index out of
+// range is masked to 0 and the result or-ed with -1.
+EMSCRIPTEN_KEEPALIVE
+int64_t fib_table(int n){
+    uint32_t i = (uint32_t)n;
+    uint32_t in_range = i <= FIB_INT64_MAX_N;
+    i &= 0u - in_range;
+    return FIB_TABLE[i] | ((int64_t)in_range - 1);
+}
+
+// Bump allocator, everything allocated from it is released at once by reset
+typedef struct Arena{
+    unsigned char *base;
+    size_t used;
+    size_t cap;
+}Arena;
+
+// 8 byte aligned block of bytes, or NULL when the arena is full
+static void *arena_alloc(Arena *arena, size_t bytes){
+    size_t start = (arena->used + 7) & ~(size_t)7;
+    if (start + bytes > arena->cap)
+        return NULL;
+    arena->used = start + bytes;
+    return arena->base + start;
+}
+
+static void arena_reset(Arena *arena){
+    arena->used = 0;
+}
+
+static unsigned char fib_memo_storage[4096];
+static Arena fib_memo_arena = {fib_memo_storage, 0, sizeof(fib_memo_storage)};
+
+static int64_t fib_memo_rec(int n, int64_t *memo){
+    if (memo[n] < 0)
+        memo[n] = fib_memo_rec(n-2, memo) + fib_memo_rec(n-1, memo);
+    return memo[n];
+}
+
+// fib_recursive with every subproblem solved once, the memo lives in an arena
+// for the duration of the call. -1 for n > 92, like fib_table.
+EMSCRIPTEN_KEEPALIVE
+int64_t fib_memoized(int n){
+    if (n <= 0)
+        return 0;
+    if (n > FIB_INT64_MAX_N)
+        return -1;
+    int64_t *memo = arena_alloc(&fib_memo_arena, (n + 1) * sizeof(int64_t));
+    memo[0] = 0;
+    memo[1] = 1;
+    for (int i = 2; i <= n; i++)
+        memo[i] = -1;
+    int64_t f = fib_memo_rec(n, memo);
+    arena_reset(&fib_memo_arena);
+    return f;
+}
+
+// Exact Fibonacci numbers by fast doubling, O(log n) big multiplications:
+//   F(2k)   = F(k) * (2F(k+1) - F(k))
+//   F(2k+1) = F(k)^2 + F(k+1)^2
+// Numbers are little endian arrays of 32-bit limbs, 32x32->64 products are
+// native on wasm32. Multiplication is Karatsuba above KARATSUBA_THRESHOLD.
+
+typedef uint32_t limb_t;
+typedef uint64_t dlimb_t;
+
+#define LIMB_BITS 32
+#define KARATSUBA_THRESHOLD 32
+
+// Limbs needed for F(n), log2(phi) * 46 < 32
+static size_t fib_limbs(unsigned n){
+    return n / 46 + 2;
+}
+
+// r = a + b for an >= bn, r has an limbs and may alias a, returns the carry
+static limb_t limbs_add(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn){
+    dlimb_t carry = 0;
+    size_t i = 0;
+    for (; i < bn; i++){
+        carry += (dlimb_t)a[i] + b[i];
+        r[i] = (limb_t)carry;
+        carry >>= LIMB_BITS;
+    }
+    for (; i < an; i++){
+        carry += a[i];
+        r[i] = (limb_t)carry;
+        carry >>= LIMB_BITS;
+    }
+    return (limb_t)carry;
+}
+
+// r = a - b for an >= bn, r has an limbs and may alias a, returns the borrow
+static limb_t limbs_sub(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn){
+    limb_t borrow = 0;
+    size_t i = 0;
+    for (; i < bn; i++){
+        dlimb_t d = (dlimb_t)a[i] - b[i] - borrow;
+        r[i] = (limb_t)d;
+        borrow = (limb_t)(d >> 63);
+    }
+    for (; i < an; i++){
+        dlimb_t d = (dlimb_t)a[i] - borrow;
+        r[i] = (limb_t)d;
+        borrow = (limb_t)(d >> 63);
+    }
+    return borrow;
+}
+
+// Length of a without leading zero limbs
+static size_t limbs_trim(const limb_t *a, size_t an){
+    while (an > 0 && a[an - 1] == 0)
+        an--;
+    return an;
+}
+
+// r = a * b, r has an + bn limbs and does not overlap a or b
+static void limbs_mul_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn){
+    memset(r, 0, (an + bn) * sizeof(limb_t));
+    for (size_t j = 0; j < bn; j++){
+        dlimb_t carry = 0;
+        dlimb_t bj = b[j];
+        limb_t *rj = r + j;
+        for (size_t i = 0; i < an; i++){
+            carry += a[i] * bj + rj[i];
+            rj[i] = (limb_t)carry;
+            carry >>= LIMB_BITS;
+        }
+        rj[an] = (limb_t)carry;
+    }
+}
+
+// Scratch limbs limbs_mul needs for an larger factor of n limbs
+static size_t limbs_mul_scratch(size_t n){
+    size_t s = 0;
+    while (n >= KARATSUBA_THRESHOLD){
+        size_t k = n - n / 2 + 1;
+        s += 4 * k;
+        n = k;
+    }
+    return s;
+}
+
+// r = a * b for an >= bn, r has an + bn limbs and does not overlap a or b.
+// scratch has limbs_mul_scratch(an) limbs.
+static void limbs_mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, limb_t *scratch){
+    if (bn < KARATSUBA_THRESHOLD){
+        limbs_mul_basecase(r, a, an, b, bn);
+        return;
+    }
+    if (2 * bn <= an){
+        // Unbalanced: multiply b by bn limb slices of a
+        limb_t *t = scratch;
+        memset(r, 0, (an + bn) * sizeof(limb_t));
+        for (size_t off = 0; off < an; off += bn){
+            size_t piece = an - off < bn ? an - off : bn;
+            if (piece >= bn)
+                limbs_mul(t, a + off, piece, b, bn, t + 2 * bn);
+            else
+                limbs_mul(t, b, bn, a + off, piece, t + 2 * bn);
+            limbs_add(r + off, r + off, an + bn - off, t, piece + bn);
+        }
+        return;
+    }
+    // Karatsuba, a = a1 B^h + a0 and b = b1 B^h + b0 with bn > h
+    size_t h = an / 2;
+    size_t a1n = an - h;
+    size_t b1n = bn - h;
+    size_t sn = a1n + 1;
+    limb_t *sa = scratch;
+    limb_t *sb = sa + sn;
+    limb_t *z1 = sb + sn;
+    limb_t *next = z1 + 2 * sn;
+
+    // z0 and z2 go straight into r
+    limbs_mul(r, a, h, b, h, next);
+    if (a1n >= b1n)
+        limbs_mul(r + 2 * h, a + h, a1n, b + h, b1n, next);
+    else
+        limbs_mul(r + 2 * h, b + h, b1n, a + h, a1n, next);
+
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+    sa[a1n] = limbs_add(sa, a + h, a1n, a, h);
+    size_t sbn;
+    if (b1n >= h){
+        sb[b1n] = limbs_add(sb, b + h, b1n, b, h);
+        sbn = b1n + 1;
+    } else {
+        sb[h] = limbs_add(sb, b, h, b + h, b1n);
+        sbn = h + 1;
+    }
+    size_t z1n = sn + sbn;
+    limbs_mul(z1, sa, sn, sb, sbn, next);
+    limbs_sub(z1, z1, z1n, r, 2 * h);
+    limbs_sub(z1, z1, z1n, r + 2 * h, a1n + b1n);
+    z1n = limbs_trim(z1, z1n);
+    limbs_add(r + h, r + h, an + bn - h, z1, z1n);
+}
+
+// One buffer for all numbers of the last fib_big call, so the result stays
+// put in linear memory until the next call
+static limb_t *fib_arena = NULL;
+static size_t fib_arena_limbs = 0;
+static const limb_t *fib_result = NULL;
+static size_t fib_result_len = 0;
+
+// r = a * b for normalized a, b, returns the length of r
+static size_t big_mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, limb_t *scratch){
+    if (an == 0 || bn == 0)
+        return 0;
+    if (an >= bn)
+        limbs_mul(r, a, an, b, bn, scratch);
+    else
+        limbs_mul(r, b, bn, a, an, scratch);
+    return limbs_trim(r, an + bn);
+}
+
+/* fib_big(n) -> limbs
+ * Computes F(n) exactly and returns its limbs, least significant first. The
+ * count is returned by fib_big_length(). The limbs stay valid until the next
+ * call, so JavaScript can read them in place:
+ *   new Uint32Array(memory.buffer, fib_big(n), fib_big_length())
+ * Returns NULL if there is not enough memory.
+ */
+EMSCRIPTEN_KEEPALIVE
+const limb_t *fib_big(unsigned n){
+    // a, b, t, c, d and the multiplication scratch
+    size_t cap = fib_limbs(n) + 8;
+    size_t need = 5 * cap + limbs_mul_scratch(cap);
+    if (need > fib_arena_limbs){
+        free(fib_arena);
+        fib_arena = malloc(need * sizeof(limb_t));
+        fib_arena_limbs = fib_arena ? need : 0;
+        if (!fib_arena){
+            fib_result = NULL;
+            fib_result_len = 0;
+            return NULL;
+        }
+    }
+    limb_t *a = fib_arena;
+    limb_t *b = a + cap;
+    limb_t *t = b + cap;
+    limb_t *c = t + cap;
+    limb_t *d = c + cap;
+    limb_t *scratch = d + cap;
+
+    // (a, b) = (F(k), F(k+1)), starting at k = 0 and doubling per bit of n
+    size_t an = 0;
+    size_t bn = 1;
+    b[0] = 1;
+    int bit = 31;
+    while (bit >= 0 && !(n >> bit & 1))
+        bit--;
+    for (; bit >= 0; bit--){
+        int odd = n >> bit & 1;
+        int last = bit == 0;
+        size_t cn = 0;
+        size_t dn = 0;
+        if (!last || !odd){
+            // c = F(2k) = a * (2b - a)
+            t[bn] = limbs_add(t, b, bn, b, bn);
+            size_t tn = limbs_trim(t, bn + 1);
+            limbs_sub(t, t, tn, a, an);
+            tn = limbs_trim(t, tn);
+            cn = big_mul(c, a, an, t, tn, scratch);
+        }
+        if (!last || odd){
+            // d = F(2k+1) = a^2 + b^2
+            size_t sq = big_mul(t, a, an, a, an, scratch);
+            dn = big_mul(d, b, bn, b, bn, scratch);
+            d[dn] = limbs_add(d, d, dn, t, sq);
+            dn = limbs_trim(d, dn + 1);
+        }
+        limb_t *old_a = a;
+        limb_t *old_b = b;
+        if (odd){
+            // (F(2k+1), F(2k+2)) = (d, c + d)
+            a = d;
+            an = dn;
+            if (!last){
+                if (cn > dn){
+                    c[cn] = limbs_add(c, c, cn, d, dn);
+                    bn = limbs_trim(c, cn + 1);
+                } else {
+                    c[dn] = limbs_add(c, d, dn, c, cn);
+                    bn = limbs_trim(c, dn + 1);
+                }
+                b = c;
+            }
+            c = old_a;
+            d = old_b;
+        } else {
+            a = c;
+            an = cn;
+            b = d;
+            bn = dn;
+            c = old_a;
+            d = old_b;
+        }
+    }
+    fib_result = a;
+    fib_result_len = an;
+    return a;
+}
+
+// Number of limbs of the last fib_big result, 0 for F(0)
+EMSCRIPTEN_KEEPALIVE
+size_t fib_big_length(void){
+    return fib_result_len;
+}
+
+// a * b mod m
+static uint64_t mulmod(uint64_t a, uint64_t b, uint64_t m){
+    return (uint64_t)((unsigned __int128)a * b % m);
+}
+
+// a + b mod m for a, b < m, without overflowing for m near 2^64
+static uint64_t addmod(uint64_t a, uint64_t b, uint64_t m){
+    return a >= m - b ? a - (m - b) : a + b;
+}
+
+// (F(n), F(n+1)) mod m by fast doubling, for m > 1
+static void fib_mod_pair(uint64_t n, uint64_t m, uint64_t *fn, uint64_t *fn1){
+    uint64_t a = 0;
+    uint64_t b = 1;
+    for (int bit = 63; bit >= 0; bit--){
+        uint64_t t = addmod(addmod(b, b, m), a ? m - a : 0, m);
+        uint64_t c = mulmod(a, t, m);
+        uint64_t d = addmod(mulmod(a, a, m), mulmod(b, b, m), m);
+        if (n >> bit & 1){
+            a = d;
+            b = addmod(c, d, m);
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+    *fn = a;
+    *fn1 = b;
+}
+
+/* fib_mod(n, m) -> F(n) mod m
+ * Fast doubling on residues, for n far beyond what fib_big can hold. Returns 0
+ * for m == 0.
+ */
+EMSCRIPTEN_KEEPALIVE
+uint64_t fib_mod(uint64_t n, uint64_t m){
+    if (m <= 1)
+        return 0;
+    uint64_t a, b;
+    fib_mod_pair(n, m, &a, &b);
+    return a;
+}
+
+// Batches work on arrays in linear memory, one call for the whole array.
+// JavaScript allocates them with fib_alloc and fills typed array views.
+
+// A batch index at most this far past the previous one is reached by
+// stepping, farther ones by fast doubling. About the cost of fib_mod_pair.
+#define FIB_BATCH_STEPS 64
+
+EMSCRIPTEN_KEEPALIVE
+void *fib_alloc(size_t bytes){
+    return malloc(bytes);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void fib_free(void *ptr){
+    free(ptr);
+}
+
+/* fib_batch(ns, out, count)
+ * out[i] = F(ns[i]) exactly, or -1 for ns[i] > FIB_INT64_MAX_N. One table
+ * lookup per index.
+ */
+EMSCRIPTEN_KEEPALIVE
+void fib_batch(const uint32_t *ns, int64_t *out, size_t count){
+    for (size_t i = 0; i < count; i++)
+        out[i] = fib_table((int)ns[i]);
+}
+
+/* fib_mod_batch(ns, out, count, m)
+ * out[i] = F(ns[i]) mod m. Clustered or sorted indices step on from the
+ * previous pair, the others start over with fast doubling. out is all 0 for
+ * m <= 1.
+ */
+EMSCRIPTEN_KEEPALIVE
+void fib_mod_batch(const uint64_t *ns, uint64_t *out, size_t count, uint64_t m){
+    if (m <= 1){
+        memset(out, 0, count * sizeof(uint64_t));
+        return;
+    }
+    uint64_t k = 0;
+    uint64_t a = 0;
+    uint64_t b = 1;
+    for (size_t i = 0; i < count; i++){
+        uint64_t n = ns[i];
+        if (n < k || n - k > FIB_BATCH_STEPS){
+            fib_mod_pair(n, m, &a, &b);
+            k = n;
+        }
+        for (; k < n; k++){
+            uint64_t next = addmod(a, b, m);
+            a = b;
+            b = next;
+        }
+        out[i] = a;
+    }
+}
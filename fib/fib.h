@@ -0,0 +1,29 @@
+#ifndef FIB_H
+#define FIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Exports of fib.c, for native programs linking it
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+long fib_recursive(int n);
+long fib_dynamic_programming(int n);
+int64_t fib_table(int n);
+int64_t fib_memoized(int n);
+const uint32_t *fib_big(unsigned n);
+size_t fib_big_length(void);
+uint64_t fib_mod(uint64_t n, uint64_t m);
+void *fib_alloc(size_t bytes);
+void fib_free(void *ptr);
+void fib_batch(const uint32_t *ns, int64_t *out, size_t count);
+void fib_mod_batch(const uint64_t *ns, uint64_t *out, size_t count, uint64_t m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
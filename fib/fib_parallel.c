@@ -0,0 +1,138 @@
+// Parallel fib_recursive on the work-stealing runtime, with a scaling benchmark.
+// Native: cc -O2 -pthread fib_parallel.c workstealing.c -o fib_parallel
+// Node:   emcc -O3 -pthread -s PROXY_TO_PTHREAD -s PTHREAD_POOL_SIZE=8
+//           fib_parallel.c workstealing.c -o fib_parallel.js
+// Run:    fib_parallel [n] [cutoff] [max workers], node fib_parallel.js ...
+#include "workstealing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Below this n a task recurses sequentially instead of spawning
+static int cutoff = 20;
+// Every time is the best of this many runs, the first one warms up
+#define REPEATS 3
+
+// The leaf of the parallel tasks, kept out of line so that every caller
+// runs the same code
+static __attribute__((noinline)) long long fib_serial(int n){
+    if (n <= 0)
+        return 0;
+    else if (n == 1)
+        return 1;
+    else
+        return fib_serial(n-2)+fib_serial(n-1);
+}
+
+// fib_task without the runtime: the same recursion down to the cutoff and
+// the same leaves, the baseline of the overhead per spawn
+static long long fib_split(int n){
+    if (n < cutoff)
+        return fib_serial(n);
+    return fib_split(n - 1) + fib_split(n - 2);
+}
+
+typedef struct FibTask{
+    Task task;
+    int n;
+    long long result;
+}FibTask;
+
+// fib_recursive with the n-1 branch spawned and the n-2 branch run in place
+static void fib_task(Task *task){
+    FibTask *f = (FibTask *)task;
+    if (f->n < cutoff){
+        f->result = fib_serial(f->n);
+        return;
+    }
+    FibTask a = {{fib_task, 0}, f->n - 1, 0};
+    FibTask b = {{fib_task, 0}, f->n - 2, 0};
+    ws_spawn(&a.task);
+    fib_task(&b.task);
+    ws_sync(&a.task);
+    f->result = a.result + b.result;
+}
+
+long long fib_parallel(int n){
+    FibTask root = {{fib_task, 0}, n, 0};
+    ws_run(&root.task);
+    return root.result;
+}
+
+static double seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Times fib(n) sequentially and then on 1 .. max workers. The speedup is
+ * against the sequential time. The overhead per spawn compares the single
+ * worker run with fib_split, which makes the same calls without spawning.
+ * Run with a small cutoff to measure the overhead, with few spawns it
+ * drowns in timing noise.
+ */
+int main(int argc, char *argv[]){
+    int n = argc > 1 ? atoi(argv[1]) : 40;
+    cutoff = argc > 2 ? atoi(argv[2]) : cutoff;
+    int max_workers = argc > 3 ? atoi(argv[3]) : 0;
+    if (max_workers <= 0){
+        max_workers = ws_init(0);
+        ws_shutdown();
+    }
+
+    long long expected = 0;
+    double serial = 0;
+    double split = 0;
+    for (int r = 0; r < REPEATS; r++){
+        double start = seconds();
+        expected = fib_serial(n);
+        double time = seconds() - start;
+        serial = r == 0 || time < serial ? time : serial;
+        start = seconds();
+        long long f = fib_split(n);
+        time = seconds() - start;
+        split = r == 0 || time < split ? time : split;
+        if (f != expected){
+            fprintf(stderr, "Error: fib_split(%d) = %lld.\n", n, f);
+            return EXIT_FAILURE;
+        }
+    }
+    printf("fib(%d) = %lld, cutoff %d\n", n, expected, cutoff);
+    printf("serial     %9.4f s\n", serial);
+    printf("split      %9.4f s\n", split);
+
+    double single = 0;
+    for (int workers = 1; workers <= max_workers; workers++){
+        if (ws_init(workers) < 0){
+            fprintf(stderr, "Error: could not start %d workers.\n", workers);
+            return EXIT_FAILURE;
+        }
+        long long result = 0;
+        double time = 0;
+        for (int r = 0; r < REPEATS; r++){
+            double start = seconds();
+            result = fib_parallel(n);
+            double t = seconds() - start;
+            time = r == 0 || t < time ? t : time;
+        }
+        WsStats stats = ws_stats();
+        ws_shutdown();
+        if (result != expected){
+            fprintf(stderr, "Error: fib_parallel(%d) = %lld with %d workers.\n",
+                    n, result, workers);
+            return EXIT_FAILURE;
+        }
+        if (workers == 1)
+            single = time;
+        // Counters add up over the repeats, both are per run
+        unsigned long long spawns = stats.spawns / REPEATS;
+        unsigned long long steals = stats.steals / REPEATS;
+        printf("%3d workers %9.4f s  speedup %5.2f  spawns %llu  steals %llu",
+               workers, time, serial / time, spawns, steals);
+        if (workers == 1 && spawns)
+            printf("  overhead %.1f ns/spawn", (single - split) * 1e9 / spawns);
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Freestanding runtime of fib.wasm when it is built without emcc, see
+// build.sh: malloc and free over the fixed memory, the mem* functions and
+// the two 128-bit helpers that fib_mod needs on wasm32.
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Heap blocks are aligned like malloc's, the header keeps that alignment
+#define ALIGN 16
+#define HEADER ((sizeof(Block) + ALIGN - 1) & ~(size_t)(ALIGN - 1))
+
+// Start of the heap, placed by wasm-ld after the data and the stack
+extern unsigned char __heap_base;
+
+typedef struct Block{
+    size_t size;                // Bytes, header included
+    struct Block *next;         // Next free block by address
+}Block;
+
+static Block *free_list;
+static uintptr_t top;           // End of the heap handed out so far
+
+/*
+ * First fit over a free list sorted by address, the rest of a block that
+ * is large enough is split off. When nothing fits the heap grows up to the
+ * end of the memory, which never grows itself.
+ */
+void *malloc(size_t bytes){
+    if (bytes > SIZE_MAX - HEADER - ALIGN)
+        return NULL;
+    size_t size = (bytes + HEADER + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+    Block **link = &free_list;
+    for (Block *b = free_list; b; link = &b->next, b = b->next){
+        if (b->size < size)
+            continue;
+        if (b->size - size >= HEADER + ALIGN){
+            Block *rest = (Block *)((unsigned char *)b + size);
+            rest->size = b->size - size;
+            rest->next = b->next;
+            *link = rest;
+            b->size = size;
+        } else
+            *link = b->next;
+        return (unsigned char *)b + HEADER;
+    }
+    if (!top)
+        top = ((uintptr_t)&__heap_base + ALIGN - 1) & ~(uintptr_t)(ALIGN - 1);
+    uintptr_t end = (uintptr_t)__builtin_wasm_memory_size(0) * 65536u;
+    if (end - top < size)
+        return NULL;
+    Block *b = (Block *)top;
+    b->size = size;
+    top += size;
+    return (unsigned char *)b + HEADER;
+}
+
+// Returns the block to the free list, merged with the free neighbours
+void free(void *ptr){
+    if (!ptr)
+        return;
+    Block *b = (Block *)((unsigned char *)ptr - HEADER);
+    Block *prev = NULL;
+    Block *next = free_list;
+    while (next && next < b){
+        prev = next;
+        next = next->next;
+    }
+    b->next = next;
+    if (next && (unsigned char *)b + b->size == (unsigned char *)next){
+        b->size += next->size;
+        b->next = next->next;
+    }
+    if (!prev){
+        free_list = b;
+        return;
+    }
+    prev->next = b;
+    if ((unsigned char *)prev + prev->size == (unsigned char *)b){
+        prev->size += b->size;
+        prev->next = b->next;
+    }
+}
+
+void *memset(void *d, int c, size_t n){
+    unsigned char *p = d;
+    while (n--)
+        *p++ = (unsigned char)c;
+    return d;
+}
+
+void *memcpy(void *restrict d, const void *restrict s, size_t n){
+    unsigned char *p = d;
+    const unsigned char *q = s;
+    while (n--)
+        *p++ = *q++;
+    return d;
+}
+
+void *memmove(void *d, const void *s, size_t n){
+    unsigned char *p = d;
+    const unsigned char *q = s;
+    if (p < q){
+        while (n--)
+            *p++ = *q++;
+    } else {
+        p += n;
+        q += n;
+        while (n--)
+            *--p = *--q;
+    }
+    return d;
+}
+
+// 128-bit integers as two 64-bit words, compiler-rt is not assumed
+typedef unsigned __int128 u128;
+
+static uint64_t low(u128 x){
+    return (uint64_t)x;
+}
+
+static uint64_t high(u128 x){
+    return (uint64_t)(x >> 64);
+}
+
+static u128 words(uint64_t hi, uint64_t lo){
+    return (u128)hi << 64 | lo;
+}
+
+// 64 x 64 -> 128 bits from the 32-bit halves
+static u128 multiply_wide(uint64_t a, uint64_t b){
+    uint64_t a0 = (uint32_t)a, a1 = a >> 32;
+    uint64_t b0 = (uint32_t)b, b1 = b >> 32;
+    uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+    return words(p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32), (mid << 32) | (uint32_t)p00);
+}
+
+// a * b mod 2^128
+u128 __multi3(u128 a, u128 b){
+    u128 p = multiply_wide(low(a), low(b));
+    return words(high(p) + low(a) * high(b) + high(a) * low(b), low(p));
+}
+
+// a mod b, restoring division a bit at a time
+u128 __umodti3(u128 a, u128 b){
+    uint64_t ah = high(a), al = low(a), bh = high(b), bl = low(b);
+    if (bh == 0){
+        // The high word natively, then the low word, the remainder stays
+        // below bl so only the bit shifted out can overflow
+        uint64_t r = ah % bl;
+        for (int k = 63; k >= 0; k--){
+            uint64_t carry = r >> 63;
+            r = (r << 1) | ((al >> k) & 1);
+            if (carry || r >= bl)
+                r -= bl;
+        }
+        return r;
+    }
+    uint64_t rh = 0, rl = 0;
+    for (int k = 127; k >= 0; k--){
+        rh = (rh << 1) | (rl >> 63);
+        rl = (rl << 1) | ((k >= 64 ? ah >> (k - 64) : al >> k) & 1);
+        if (rh > bh || (rh == bh && rl >= bl)){
+            uint64_t borrow = rl < bl;
+            rl -= bl;
+            rh -= bh + borrow;
+        }
+    }
+    return words(rh, rl);
+}
@@ -0,0 +1,11 @@
+#ifndef WASM_STDLIB_H
+#define WASM_STDLIB_H
+
+#include <stddef.h>
+
+// The part of stdlib.h fib.c uses, implemented in runtime.c
+
+void *malloc(size_t bytes);
+void free(void *ptr);
+
+#endif
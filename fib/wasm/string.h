@@ -0,0 +1,12 @@
+#ifndef WASM_STRING_H
+#define WASM_STRING_H
+
+#include <stddef.h>
+
+// The part of string.h fib.c uses, implemented in runtime.c
+
+void *memset(void *d, int c, size_t n);
+void *memcpy(void *restrict d, const void *restrict s, size_t n);
+void *memmove(void *d, const void *s, size_t n);
+
+#endif
@@ -0,0 +1,241 @@
+#include "workstealing.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Deque capacity per worker, a power of two. Fork/join keeps at most one
+// entry per nesting level of spawns in a deque.
+#define WS_DEQUE_SIZE 4096
+#define WS_MAX_WORKERS 256
+// Failed steals before an idle worker yields its core
+#define WS_SPIN_STEALS 64
+#define WS_CACHE_LINE 64
+
+/*
+ * Chase-Lev deque with the C11 memory orderings of Le, Pop, Cohen and
+ * Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (PPoPP 2013). Fixed size, a full deque makes the spawn run
+ * inline instead.
+ */
+typedef struct Deque{
+    _Alignas(WS_CACHE_LINE) atomic_llong top;
+    _Alignas(WS_CACHE_LINE) atomic_llong bottom;
+    _Alignas(WS_CACHE_LINE) Task *_Atomic buffer[WS_DEQUE_SIZE];
+}Deque;
+
+// Owner only, 0 if the deque is full
+static int deque_push(Deque *q, Task *task){
+    long long b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+    long long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    if (b - t >= WS_DEQUE_SIZE)
+        return 0;
+    atomic_store_explicit(&q->buffer[b & (WS_DEQUE_SIZE - 1)], task, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    return 1;
+}
+
+// Owner only, newest task or NULL
+static Task *deque_pop(Deque *q){
+    long long b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&q->top, memory_order_relaxed);
+    if (t > b){
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    Task *task = atomic_load_explicit(&q->buffer[b & (WS_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (t == b){
+        // Last task, race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+                memory_order_seq_cst, memory_order_relaxed))
+            task = NULL;
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+// Any thread, oldest task or NULL when empty or lost to another thief
+static Task *deque_steal(Deque *q){
+    long long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+    if (t >= b)
+        return NULL;
+    Task *task = atomic_load_explicit(&q->buffer[t & (WS_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+            memory_order_seq_cst, memory_order_relaxed))
+        return NULL;
+    return task;
+}
+
+typedef struct Worker{
+    Deque deque;
+    pthread_t thread;
+    uint64_t rng;
+    WsStats stats;
+}Worker;
+
+static struct{
+    Worker *workers;
+    int count;
+    atomic_int stop;
+    // Roots in flight, idle workers sleep while there are none
+    atomic_int active;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+}pool = {NULL, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static _Thread_local Worker *self = NULL;
+
+static void run_task(Task *task){
+    task->run(task);
+    atomic_store_explicit(&task->done, 1, memory_order_release);
+}
+
+// One steal attempt from a random other worker
+static Task *steal_one(Worker *w){
+    if (pool.count < 2)
+        return NULL;
+    // xorshift64
+    w->rng ^= w->rng << 13;
+    w->rng ^= w->rng >> 7;
+    w->rng ^= w->rng << 17;
+    int victim = (int)(w->rng % (uint64_t)(pool.count - 1));
+    if (victim >= w - pool.workers)
+        victim++;
+    Task *task = deque_steal(&pool.workers[victim].deque);
+    if (task)
+        w->stats.steals++;
+    return task;
+}
+
+static void *worker_main(void *arg){
+    Worker *w = arg;
+    self = w;
+    int fails = 0;
+    while (!atomic_load_explicit(&pool.stop, memory_order_acquire)){
+        if (!atomic_load_explicit(&pool.active, memory_order_acquire)){
+            pthread_mutex_lock(&pool.lock);
+            while (!atomic_load(&pool.active) && !atomic_load(&pool.stop))
+                pthread_cond_wait(&pool.wake, &pool.lock);
+            pthread_mutex_unlock(&pool.lock);
+            continue;
+        }
+        Task *task = steal_one(w);
+        if (task){
+            run_task(task);
+            fails = 0;
+        } else if (++fails >= WS_SPIN_STEALS){
+            sched_yield();
+            fails = 0;
+        }
+    }
+    return NULL;
+}
+
+int ws_init(int workers){
+    ws_shutdown();
+    if (workers <= 0){
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (int)cpus : 1;
+    }
+    if (workers > WS_MAX_WORKERS)
+        workers = WS_MAX_WORKERS;
+    pool.workers = aligned_alloc(WS_CACHE_LINE, workers * sizeof(Worker));
+    if (!pool.workers)
+        return -1;
+    memset(pool.workers, 0, workers * sizeof(Worker));
+    atomic_store(&pool.stop, 0);
+    atomic_store(&pool.active, 0);
+    pool.count = 1;
+    pool.workers[0].rng = 0x9E3779B97F4A7C15ull;
+    for (int i = 1; i < workers; i++){
+        Worker *w = &pool.workers[i];
+        w->rng = 0x9E3779B97F4A7C15ull * (uint64_t)(i + 1);
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0){
+            ws_shutdown();
+            return -1;
+        }
+        pool.count++;
+    }
+    return pool.count;
+}
+
+void ws_shutdown(void){
+    if (!pool.workers)
+        return;
+    pthread_mutex_lock(&pool.lock);
+    atomic_store(&pool.stop, 1);
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 1; i < pool.count; i++)
+        pthread_join(pool.workers[i].thread, NULL);
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.count = 0;
+}
+
+int ws_workers(void){
+    return pool.count;
+}
+
+void ws_run(Task *root){
+    Worker *outer = self;
+    self = &pool.workers[0];
+    pthread_mutex_lock(&pool.lock);
+    atomic_fetch_add(&pool.active, 1);
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    atomic_store_explicit(&root->done, 0, memory_order_relaxed);
+    run_task(root);
+
+    atomic_fetch_sub(&pool.active, 1);
+    self = outer;
+}
+
+void ws_spawn(Task *task){
+    Worker *w = self;
+    atomic_store_explicit(&task->done, 0, memory_order_relaxed);
+    w->stats.spawns++;
+    if (!deque_push(&w->deque, task))
+        run_task(task);
+}
+
+void ws_sync(Task *task){
+    Worker *w = self;
+    if (atomic_load_explicit(&task->done, memory_order_acquire))
+        return;
+    // Not stolen: task is the newest entry of the own deque. Otherwise it was
+    // stolen along with everything older, and the deque is empty.
+    if (deque_pop(&w->deque) == task){
+        run_task(task);
+        return;
+    }
+    // Help out until the thief is done
+    int fails = 0;
+    while (!atomic_load_explicit(&task->done, memory_order_acquire)){
+        Task *other = steal_one(w);
+        if (other){
+            run_task(other);
+            fails = 0;
+        } else if (++fails >= WS_SPIN_STEALS){
+            sched_yield();
+            fails = 0;
+        }
+    }
+}
+
+WsStats ws_stats(void){
+    WsStats total = {0, 0};
+    for (int i = 0; i < pool.count; i++){
+        total.spawns += pool.workers[i].stats.spawns;
+        total.steals += pool.workers[i].stats.steals;
+    }
+    return total;
+}
@@ -0,0 +1,59 @@
+#ifndef WORKSTEALING_H
+#define WORKSTEALING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fork/join runtime with work stealing. Every worker owns a Chase-Lev deque:
+ * it pushes and pops spawned tasks at the bottom, idle workers steal the
+ * oldest task from the top of a random victim. The calling thread of ws_run
+ * is worker 0, ws_init starts the others as pthreads (Emscripten pthreads
+ * in the browser and under Node).
+ *
+ * Tasks are owned by the caller, usually on the stack of the spawning
+ * function, so a spawn allocates nothing:
+ *
+ *   typedef struct { Task task; int n; long long result; } FibTask;
+ *   FibTask a = {{fib_task, 0}, n - 1, 0};
+ *   ws_spawn(&a.task);   // a may now run on another worker
+ *   ...                  // the spawner keeps working
+ *   ws_sync(&a.task);    // a has finished, a.result can be read
+ *
+ * A task must be synced before its storage goes away, and a worker syncs its
+ * tasks in the reverse order of spawning them. ws_spawn and ws_sync may only
+ * be called from inside ws_run.
+ */
+
+typedef struct Task Task;
+struct Task{
+    void (*run)(Task *task);
+    atomic_int done; // Set by the runtime, wait for it with ws_sync
+};
+
+// Counters of one worker, since the last ws_init
+typedef struct WsStats{
+    uint64_t spawns;
+    uint64_t steals;
+}WsStats;
+
+// Starts workers - 1 threads, 0 picks one per online CPU. Returns the number
+// of workers, or -1 if a thread could not be started.
+int ws_init(int workers);
+// Stops and joins the threads
+void ws_shutdown(void);
+int ws_workers(void);
+
+// Runs root and everything it spawns, returns when root has finished
+void ws_run(Task *root);
+// Makes task available to other workers, the spawner runs it itself at
+// ws_sync unless it was stolen. Runs task right away if the deque is full.
+void ws_spawn(Task *task);
+// Returns once task has run, working on other tasks while it is stolen
+void ws_sync(Task *task);
+
+// Sum of the counters of all workers
+WsStats ws_stats(void);
+
+#endif
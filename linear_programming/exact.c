@@ -0,0 +1,413 @@
+#include "exact.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EXACT_ALIGN 64
+
+typedef __int128 wide;
+
+static size_t aligned_size(size_t bytes){
+    return (bytes + EXACT_ALIGN - 1) & ~(size_t)(EXACT_ALIGN - 1);
+}
+
+static int fits_int64(wide x){
+    return x >= INT64_MIN && x <= INT64_MAX;
+}
+
+static wide wide_gcd(wide x, wide y){
+    if (x < 0)
+        x = -x;
+    if (y < 0)
+        y = -y;
+    while (y != 0){
+        wide r = x % y;
+        x = y;
+        y = r;
+    }
+    return x;
+}
+
+ExactTableu *exact_create(int rows, int columns, const RowType *row_types){
+    if (rows <= 0 || columns <= 0)
+        return NULL;
+    int slacks = 0;
+    for (int i = 0; i < rows; i++)
+        slacks += row_types[i] != ROW_EQ;
+    int total = columns + slacks + rows;
+    size_t stride = ((size_t)total + 1 + 7) & ~(size_t)7;
+
+    size_t a_bytes = aligned_size((size_t)(rows + 1) * stride * sizeof(int64_t));
+    size_t input_bytes = aligned_size((size_t)rows * columns * sizeof(Fractional));
+    size_t z_bytes = aligned_size((size_t)columns * sizeof(Fractional));
+    size_t b_bytes = aligned_size((size_t)rows * sizeof(Fractional));
+    size_t basis_bytes = aligned_size((size_t)rows * sizeof(int));
+    size_t non_basis_bytes = aligned_size((size_t)(total - rows) * sizeof(int));
+    size_t types_bytes = aligned_size((size_t)rows * sizeof(RowType));
+    size_t bytes = a_bytes + input_bytes + z_bytes + b_bytes + basis_bytes +
+                   non_basis_bytes + types_bytes;
+
+    ExactTableu *t = calloc(1, sizeof(ExactTableu));
+    unsigned char *p = aligned_alloc(EXACT_ALIGN, bytes);
+    if (!t || !p){
+        free(t);
+        free(p);
+        return NULL;
+    }
+    memset(p, 0, bytes);
+    t->storage = p;
+    t->rows = rows;
+    t->columns = columns;
+    t->slacks = slacks;
+    t->total = total;
+    t->stride = stride;
+    t->denominator = 1;
+    t->cost_scale = 1;
+    t->a_matrix = (int64_t *)p;
+    p += a_bytes;
+    t->a_input = (Fractional *)p;
+    p += input_bytes;
+    t->z_vector = (Fractional *)p;
+    p += z_bytes;
+    t->b_vector = (Fractional *)p;
+    p += b_bytes;
+    t->basis_headers = (int *)p;
+    p += basis_bytes;
+    t->non_basis_headers = (int *)p;
+    p += non_basis_bytes;
+    t->row_types = (RowType *)p;
+    memcpy(t->row_types, row_types, (size_t)rows * sizeof(RowType));
+
+    // Zero is 0/1
+    for (int k = 0; k < rows * columns; k++)
+        t->a_input[k].denominator = 1;
+    for (int j = 0; j < columns; j++)
+        t->z_vector[j].denominator = 1;
+    for (int i = 0; i < rows; i++)
+        t->b_vector[i].denominator = 1;
+    return t;
+}
+
+void exact_destroy(ExactTableu *t){
+    if (!t)
+        return;
+    free(t->storage);
+    free(t);
+}
+
+// Positive denominator, as fdiv may leave it negative
+static Fractional positive_denominator(Fractional v){
+    if (v.big){
+        fprintf(stderr, "Error: tableau input does not fit 64 bits.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (v.denominator == 0){
+        fprintf(stderr, "Error: Division by zero.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (v.denominator < 0){
+        v.numerator = -v.numerator;
+        v.denominator = -v.denominator;
+    }
+    return v;
+}
+
+void exact_set_a(ExactTableu *t, int i, int j, Fractional v){
+    t->a_input[(size_t)i * t->columns + j] = positive_denominator(v);
+}
+
+void exact_set_b(ExactTableu *t, int i, Fractional v){
+    t->b_vector[i] = positive_denominator(v);
+}
+
+void exact_set_z(ExactTableu *t, int j, Fractional v){
+    t->z_vector[j] = positive_denominator(v);
+}
+
+static int64_t *exact_row(const ExactTableu *t, int i){
+    return t->a_matrix + (size_t)i * t->stride;
+}
+
+/*
+ * The pivot row keeps its entries, every other row gets the 2x2 determinant
+ * divided by the old denominator. The products are done in 64 bits while
+ * they fit and in 128 bits otherwise.
+ */
+int bareiss_pivot(int64_t *matrix, int rows, size_t stride, size_t width, int r,
+                  int q, int64_t *denominator){
+    const int64_t *pr = matrix + (size_t)r * stride;
+    const int64_t p = pr[q];
+    const int64_t d = *denominator;
+    for (int i = 0; i < rows; i++){
+        if (i == r)
+            continue;
+        int64_t *row = matrix + (size_t)i * stride;
+        const int64_t f = row[q];
+        for (size_t j = 0; j < width; j++){
+            int64_t x, y, v;
+            if (!__builtin_mul_overflow(p, row[j], &x) &&
+                !__builtin_mul_overflow(f, pr[j], &y) &&
+                !__builtin_sub_overflow(x, y, &v)){
+                row[j] = d == 1 ? v : v / d;
+            } else {
+                wide w = ((wide)p * row[j] - (wide)f * pr[j]) / d;
+                if (!fits_int64(w))
+                    return -1;
+                row[j] = (int64_t)w;
+            }
+        }
+    }
+    *denominator = p;
+    return 0;
+}
+
+// Pivots variable q into the basis at row r, keeping the denominator positive
+static int pivot(ExactTableu *t, int r, int q){
+    if (bareiss_pivot(t->a_matrix, t->rows + 1, t->stride, t->stride, r, q,
+                      &t->denominator))
+        return -1;
+    if (t->denominator < 0){
+        for (size_t k = 0; k < (size_t)(t->rows + 1) * t->stride; k++)
+            t->a_matrix[k] = -t->a_matrix[k];
+        t->denominator = -t->denominator;
+    }
+    int leaving = t->basis_headers[r];
+    t->basis_headers[r] = q;
+    for (int k = 0; k < t->total - t->rows; k++){
+        if (t->non_basis_headers[k] == q){
+            t->non_basis_headers[k] = leaving;
+            break;
+        }
+    }
+    t->iterations++;
+    return 0;
+}
+
+static int artificial_begin(const ExactTableu *t){
+    return t->columns + t->slacks;
+}
+
+// Entering column with a negative reduced cost, -1 if optimal. The reduced
+// costs share the denominator, so they compare as integers.
+static int price(const ExactTableu *t, Pricing pricing){
+    const int64_t *d = exact_row(t, t->rows);
+    const int end = artificial_begin(t);
+    int best = -1;
+    int64_t best_d = 0;
+    for (int j = 0; j < end; j++){
+        if (d[j] < best_d){
+            best = j;
+            if (pricing == PRICING_BLAND)
+                break;
+            best_d = d[j];
+        }
+    }
+    return best;
+}
+
+// Leaving row for column q by exact cross multiplied ratios, ties to the
+// lowest basic variable. -1 if q is unbounded.
+static int ratio_test(const ExactTableu *t, int q, int *degenerate){
+    const int rhs = t->total;
+    int best = -1;
+    for (int i = 0; i < t->rows; i++){
+        const int64_t *row = exact_row(t, i);
+        if (row[q] <= 0)
+            continue;
+        if (best < 0){
+            best = i;
+            continue;
+        }
+        const int64_t *b = exact_row(t, best);
+        wide lhs = (wide)row[rhs] * b[q];
+        wide rhs_best = (wide)b[rhs] * row[q];
+        if (lhs < rhs_best ||
+            (lhs == rhs_best && t->basis_headers[i] < t->basis_headers[best]))
+            best = i;
+    }
+    *degenerate = best >= 0 && exact_row(t, best)[rhs] == 0;
+    return best;
+}
+
+// Objective row D c - sum c_B a_i for integer costs, -1 on overflow
+static int price_out(ExactTableu *t, const int64_t *costs){
+    int64_t *d = exact_row(t, t->rows);
+    for (size_t j = 0; j < t->stride; j++){
+        wide v = j < (size_t)t->total ? (wide)t->denominator * costs[j] : 0;
+        for (int i = 0; i < t->rows; i++){
+            int64_t c = costs[t->basis_headers[i]];
+            if (c != 0)
+                v -= (wide)c * exact_row(t, i)[j];
+        }
+        if (!fits_int64(v))
+            return -1;
+        d[j] = (int64_t)v;
+    }
+    return 0;
+}
+
+static SimplexStatus iterate(ExactTableu *t, Pricing pricing, int max_iterations){
+    int degenerate_run = 0;
+    while (t->iterations < max_iterations){
+        Pricing rule = pricing == PRICING_BLAND || degenerate_run >= 50
+                           ? PRICING_BLAND : PRICING_DANTZIG;
+        int q = price(t, rule);
+        if (q < 0)
+            return SIMPLEX_OPTIMAL;
+        int degenerate;
+        int r = ratio_test(t, q, &degenerate);
+        if (r < 0)
+            return SIMPLEX_UNBOUNDED;
+        degenerate_run = degenerate ? degenerate_run + 1 : 0;
+        if (pivot(t, r, q))
+            return SIMPLEX_OVERFLOW;
+    }
+    return SIMPLEX_ITERATION_LIMIT;
+}
+
+// Multiplies v by scale into an integer, -1 on overflow
+static int scaled(Fractional v, wide scale, int64_t *out){
+    wide x = (wide)v.numerator * (scale / v.denominator);
+    if (!fits_int64(x))
+        return -1;
+    *out = (int64_t)x;
+    return 0;
+}
+
+static int lcm_into(wide *l, int64_t denominator){
+    *l = *l / wide_gcd(*l, denominator) * denominator;
+    return fits_int64(*l) ? 0 : -1;
+}
+
+// Scales each row to integers by the lcm of its denominators, writes the
+// slacks, artificials and rhs and picks the starting basis like simplex.c
+static int prepare(ExactTableu *t){
+    const int rhs = t->total;
+    const int art = artificial_begin(t);
+    int slack = t->columns;
+    memset(t->a_matrix, 0, (size_t)(t->rows + 1) * t->stride * sizeof(int64_t));
+    t->denominator = 1;
+    for (int i = 0; i < t->rows; i++){
+        const Fractional *in = t->a_input + (size_t)i * t->columns;
+        int64_t *row = exact_row(t, i);
+        wide l = 1;
+        for (int j = 0; j < t->columns; j++)
+            if (lcm_into(&l, in[j].denominator))
+                return -1;
+        if (lcm_into(&l, t->b_vector[i].denominator))
+            return -1;
+        // Negate rows with b < 0
+        wide sign = t->b_vector[i].numerator < 0 ? -1 : 1;
+        for (int j = 0; j < t->columns; j++)
+            if (scaled(in[j], sign * l, &row[j]))
+                return -1;
+        if (scaled(t->b_vector[i], sign * l, &row[rhs]))
+            return -1;
+        int slack_column = -1;
+        if (t->row_types[i] != ROW_EQ){
+            slack_column = slack++;
+            row[slack_column] = (t->row_types[i] == ROW_LE ? 1 : -1) * (int64_t)sign;
+        }
+        row[art + i] = 1;
+        t->basis_headers[i] = slack_column >= 0 && row[slack_column] > 0 ? slack_column : art + i;
+    }
+    int k = 0;
+    for (int j = 0; j < t->total; j++){
+        int basic = 0;
+        for (int i = 0; i < t->rows && !basic; i++)
+            basic = t->basis_headers[i] == j;
+        if (!basic)
+            t->non_basis_headers[k++] = j;
+    }
+    return 0;
+}
+
+SimplexStatus exact_solve(ExactTableu *t, const SimplexOptions *options){
+    if (!options)
+        options = &SIMPLEX_DEFAULTS;
+    int max_iterations = options->max_iterations;
+    if (max_iterations <= 0)
+        max_iterations = 50 * (t->rows + t->total);
+    t->iterations = 0;
+    t->phase1_iterations = 0;
+    if (prepare(t))
+        return SIMPLEX_OVERFLOW;
+
+    const int art = artificial_begin(t);
+    int64_t *costs = calloc((size_t)t->total, sizeof(int64_t));
+    if (!costs)
+        return SIMPLEX_OUT_OF_MEMORY;
+
+    SimplexStatus status = SIMPLEX_OPTIMAL;
+    int artificials = 0;
+    for (int i = 0; i < t->rows; i++){
+        if (t->basis_headers[i] >= art){
+            costs[t->basis_headers[i]] = 1;
+            artificials++;
+        }
+    }
+    if (artificials){
+        if (price_out(t, costs))
+            status = SIMPLEX_OVERFLOW;
+        else
+            status = iterate(t, options->pricing, max_iterations);
+        t->phase1_iterations = t->iterations;
+        if (status == SIMPLEX_OPTIMAL && exact_row(t, t->rows)[t->total] != 0)
+            status = SIMPLEX_INFEASIBLE;
+        // Drive out the artificials left basic at zero
+        for (int i = 0; status == SIMPLEX_OPTIMAL && i < t->rows; i++){
+            if (t->basis_headers[i] < art)
+                continue;
+            const int64_t *row = exact_row(t, i);
+            for (int j = 0; j < art; j++){
+                if (row[j] != 0){
+                    if (pivot(t, i, j))
+                        status = SIMPLEX_OVERFLOW;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (status == SIMPLEX_OPTIMAL){
+        wide l = 1;
+        for (int j = 0; j < t->columns && status == SIMPLEX_OPTIMAL; j++)
+            if (lcm_into(&l, t->z_vector[j].denominator))
+                status = SIMPLEX_OVERFLOW;
+        t->cost_scale = (int64_t)l;
+        for (int j = 0; j < t->total && status == SIMPLEX_OPTIMAL; j++){
+            costs[j] = 0;
+            if (j < t->columns && scaled(t->z_vector[j], l, &costs[j]))
+                status = SIMPLEX_OVERFLOW;
+        }
+        if (status == SIMPLEX_OPTIMAL && price_out(t, costs))
+            status = SIMPLEX_OVERFLOW;
+        if (status == SIMPLEX_OPTIMAL)
+            status = iterate(t, options->pricing, max_iterations);
+    }
+    free(costs);
+    return status;
+}
+
+// -rhs / (D * cost_scale), promoted by fmul if it outgrows 64 bits
+Fractional exact_objective(const ExactTableu *t){
+    Fractional v = {exact_row(t, t->rows)[t->total], t->denominator, NULL};
+    Fractional scale = {-1, t->cost_scale, NULL};
+    return fmul(&v, &scale);
+}
+
+void exact_solution(const ExactTableu *t, Fractional *x){
+    for (int j = 0; j < t->columns; j++){
+        Fractional zero = {0, 1, NULL};
+        x[j] = zero;
+    }
+    for (int i = 0; i < t->rows; i++){
+        int j = t->basis_headers[i];
+        if (j < t->columns){
+            Fractional v = {exact_row(t, i)[t->total], t->denominator, NULL};
+            gcd_shrink(&v);
+            x[j] = v;
+        }
+    }
+}
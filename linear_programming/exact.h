@@ -0,0 +1,74 @@
+#ifndef EXACT_H
+#define EXACT_H
+
+#include "simplex.h"
+#include "value.h"
+
+/*
+ * Exact simplex tableau on integers, with fraction-free (Bareiss) pivoting.
+ *
+ * The tableau is kept as integers over one common denominator D, the
+ * determinant of the current basis: entry (i, j) stands for a[i][j] / D. A
+ * pivot on (r, q) with p = a[r][q] replaces every other entry by
+ *
+ *   (p * a[i][j] - a[i][q] * a[r][j]) / D
+ *
+ * where the division is exact, and D becomes p. So an update is one multiply
+ * subtract divide per cell instead of the gcd loops of fadd/fmul, and the
+ * entries only grow as the minors of A do. Nothing is reduced while pivoting;
+ * values are normalized to Fractional once, when they are read out.
+ *
+ * Entries are int64_t, 64 bits on every target including wasm32.
+ * Input rows are Fractional, each row is scaled by the lcm of its
+ * denominators to integers once when solving. Same column layout as Tableu:
+ * [A | slacks | artificials | rhs], the objective row is row `rows`.
+ */
+typedef struct ExactTableu{
+    int rows;
+    int columns;
+    int slacks;
+    int total;                  // columns + slacks + rows
+    size_t stride;              // Integers per tableau row
+    RowType *row_types;
+    Fractional *z_vector;       // c, n costs
+    Fractional *a_input;        // A, rows x columns
+    Fractional *b_vector;       // b
+    int64_t *a_matrix;          // rows + 1 rows of stride, the last is the objective
+    int64_t denominator;        // D, > 0
+    int64_t cost_scale;         // lcm of the cost denominators
+    int *basis_headers;
+    int *non_basis_headers;     // total - rows variables
+    int iterations;
+    int phase1_iterations;
+    void *storage;
+}ExactTableu;
+
+/* exact_create(rows, columns, row_types) -> tableu
+ * Zeroed exact tableau, see tableu_create. NULL if out of memory.
+ */
+ExactTableu *exact_create(int rows, int columns, const RowType *row_types);
+void exact_destroy(ExactTableu *t);
+void exact_set_a(ExactTableu *t, int i, int j, Fractional v);
+void exact_set_b(ExactTableu *t, int i, Fractional v);
+void exact_set_z(ExactTableu *t, int j, Fractional v);
+
+/* exact_solve(t, options) -> status
+ * Two phase primal simplex in exact arithmetic. Dantzig and Bland pricing,
+ * steepest edge and devex price like Dantzig. SIMPLEX_OVERFLOW if an entry outgrows
+ * 64 bits, SIMPLEX_OUT_OF_MEMORY if the work arrays can not be allocated.
+ */
+SimplexStatus exact_solve(ExactTableu *t, const SimplexOptions *options);
+// z^T x of the current basis, reduced
+Fractional exact_objective(const ExactTableu *t);
+// Values of the n structural variables, reduced
+void exact_solution(const ExactTableu *t, Fractional *x);
+
+/* bareiss_pivot(matrix, rows, stride, width, r, q, denominator) -> 0 or -1
+ * Fraction-free pivot on (r, q) of rows x width integers, stride apart.
+ * *denominator is the common denominator before the pivot and becomes the
+ * pivot element. -1, with the matrix partly updated, if an entry overflows.
+ */
+int bareiss_pivot(int64_t *matrix, int rows, size_t stride, size_t width, int r,
+                  int q, int64_t *denominator);
+
+#endif
@@ -0,0 +1,168 @@
+// cc -O2 exact_bench.c exact.c simplex.c simplex_data.c value.c -DVALUE_NO_MAIN -lm -o exact_bench
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#include "exact.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Exact arithmetic, fraction-free against Fractional:
+ *
+ *   gauss_jordan_n  inverts a random n x n integer matrix with bareiss_pivot
+ *                   and with fsub/fmul/fdiv, gcd_shrink on every operation,
+ *                   and checks that both agree. bareiss_pivot stops on
+ *                   overflow, Fractional promotes to big rationals once the
+ *                   cross multiplied denominators outgrow 64 bits
+ *   exact_*         solves LPs with exact_solve next to simplex_solve
+ */
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t lcg(uint32_t *x){
+    *x = *x * 1664525u + 1013904223u;
+    return *x >> 8;
+}
+
+static void *checked_malloc(size_t bytes){
+    void *p = malloc(bytes);
+    if (!p){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Entries in -1..1 off the diagonal, the determinant stays within 64 bits
+static int64_t entry(uint32_t *x, int i, int j, int n){
+    return i == j ? n / 2 + 2 : (int64_t)(lcg(x) % 3) - 1;
+}
+
+static void gauss_jordan(int n){
+    const int width = 2 * n;
+    int64_t *m = checked_malloc(sizeof(int64_t) * n * width);
+    Fractional *f = checked_malloc(sizeof(Fractional) * n * width);
+    uint32_t x = 99;
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            m[i * width + j] = entry(&x, i, j, n);
+            m[i * width + n + j] = i == j;
+        }
+    }
+    for (int k = 0; k < n * width; k++){
+        Fractional v = {m[k], 1, NULL};
+        f[k] = v;
+    }
+
+    double start = now_seconds();
+    int64_t denominator = 1;
+    int overflow = 0;
+    for (int k = 0; k < n && !overflow; k++)
+        overflow = bareiss_pivot(m, n, width, width, k, k, &denominator);
+    double bareiss = now_seconds() - start;
+
+    start = now_seconds();
+    const Fractional zero = {0, 1, NULL};
+    for (int k = 0; k < n; k++){
+        Fractional p = fcopy(&f[k * width + k]);
+        for (int j = 0; j < width; j++){
+            Fractional q = fdiv(&f[k * width + j], &p);
+            ffree(&f[k * width + j]);
+            f[k * width + j] = q;
+        }
+        ffree(&p);
+        for (int i = 0; i < n; i++){
+            if (i == k || fcompare(&f[i * width + k], &zero) == 0)
+                continue;
+            Fractional a = fcopy(&f[i * width + k]);
+            for (int j = 0; j < width; j++){
+                Fractional t = fmul(&a, &f[k * width + j]);
+                Fractional s = fsub(&f[i * width + j], &t);
+                ffree(&t);
+                ffree(&f[i * width + j]);
+                f[i * width + j] = s;
+            }
+            ffree(&a);
+        }
+    }
+    double fractional = now_seconds() - start;
+
+    int mismatches = 0;
+    for (int i = 0; i < n && !overflow; i++){
+        for (int j = n; j < width; j++){
+            // The left block is now D times the identity
+            Fractional e = {m[i * width + j], denominator, NULL};
+            mismatches += fcompare(&e, &f[i * width + j]) != 0;
+        }
+    }
+    printf("gauss_jordan_%-3d bareiss %9.3f ms  fractional %9.3f ms  %5.1fx  %s\n",
+           n, bareiss * 1e3, fractional * 1e3, fractional / bareiss,
+           overflow ? "bareiss overflowed" : mismatches ? "MISMATCH" : "equal");
+    for (int k = 0; k < n * width; k++)
+        ffree(&f[k]);
+    free(m);
+    free(f);
+}
+
+static const char *STATUS_NAMES[] = {"optimal", "infeasible", "unbounded", "limit", "overflow",
+                                     "singular", "memory"};
+
+// max c x  s.t.  A x <= b, small positive integers, and the same in doubles
+static void exact_dense(int n){
+    RowType *types = checked_malloc(sizeof(RowType) * n);
+    for (int i = 0; i < n; i++)
+        types[i] = ROW_LE;
+    ExactTableu *e = exact_create(n, n, types);
+    Tableu *t = tableu_create(n, n, types);
+    free(types);
+    if (!e || !t){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t x = 12345;
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            int64_t a = 1 + lcg(&x) % 9;
+            exact_set_a(e, i, j, (Fractional){a, 1, NULL});
+            tableu_set_a(t, i, j, a);
+        }
+        int64_t b = 10 + lcg(&x) % 90;
+        exact_set_b(e, i, (Fractional){b, 1, NULL});
+        tableu_set_b(t, i, b);
+    }
+    for (int j = 0; j < n; j++){
+        int64_t c = -(1 + (int64_t)(lcg(&x) % 9));
+        exact_set_z(e, j, (Fractional){c, 2, NULL});
+        tableu_set_z(t, j, c / 2.0);
+    }
+    double start = now_seconds();
+    SimplexStatus status = exact_solve(e, NULL);
+    double seconds = now_seconds() - start;
+    simplex_solve(t, NULL);
+    Fractional z = status == SIMPLEX_OPTIMAL ? exact_objective(e) : (Fractional){0, 1, NULL};
+    printf("exact_dense_%-4d %-9s ", n, STATUS_NAMES[status]);
+    fprint_value(stdout, &z);
+    printf(" = %.9f (double %.9f)  %d pivots  %.3f ms  D %" PRId64 "\n",
+           get_double_value(&z), simplex_objective(t), e->iterations,
+           seconds * 1e3, e->denominator);
+    ffree(&z);
+    exact_destroy(e);
+    tableu_destroy(t);
+}
+
+int main(void){
+    gauss_jordan(6);
+    gauss_jordan(8);
+    gauss_jordan(10);
+    gauss_jordan(14);
+    exact_dense(5);
+    exact_dense(10);
+    exact_dense(20);
+    exact_dense(40);
+    return 0;
+}
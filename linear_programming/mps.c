@@ -0,0 +1,921 @@
+#define _POSIX_C_SOURCE 200809L // mmap, posix_madvise, clock_gettime
+#include "mps.h"
+#include <ctype.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Bytes of names per arena chunk
+#define ARENA_CHUNK (1 << 20)
+// Fields per line, more is a syntax error
+#define MAX_TOKENS 8
+// Row table values of N rows
+#define OBJECTIVE_ROW -1
+#define FREE_ROW -2
+// BOUNDS, RHS and RANGES values at least this large are infinite
+#define MPS_INFINITY 1e30
+// split entry of a row that bounds nothing and loses its entries
+#define DROPPED_ROW -2
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Names live in a chain of large chunks, newest first, and are freed all at
+ * once with the model. The hash tables and the name arrays point into it.
+ */
+struct MpsArena{
+    MpsArena *next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
+// Copies n bytes of s into the arena, NUL terminated. NULL if out of memory.
+static const char *arena_copy(MpsArena **arena, const char *s, size_t n){
+    MpsArena *a = *arena;
+    if (!a || a->size - a->used < n + 1){
+        size_t size = n + 1 > ARENA_CHUNK ? n + 1 : ARENA_CHUNK;
+        a = malloc(sizeof(MpsArena) + size);
+        if (!a)
+            return NULL;
+        a->next = *arena;
+        a->used = 0;
+        a->size = size;
+        *arena = a;
+    }
+    char *copy = a->data + a->used;
+    memcpy(copy, s, n);
+    copy[n] = '\0';
+    a->used += n + 1;
+    return copy;
+}
+
+static void arena_destroy(MpsArena *a){
+    while (a){
+        MpsArena *next = a->next;
+        free(a);
+        a = next;
+    }
+}
+
+/*
+ * Interned names -> index, open addressing with linear probing on a power
+ * of two table kept at most half full. A slot holds the full hash next to
+ * the key and the value, so a probe is one cache line and only compares
+ * strings that are likely equal.
+ */
+typedef struct NameSlot{
+    const char *key;            // NULL for empty slots
+    uint32_t hash;
+    int value;
+}NameSlot;
+
+typedef struct NameTable{
+    NameSlot *slots;
+    size_t capacity;
+    size_t count;
+}NameTable;
+
+// FNV-1a
+static uint32_t hash_name(const char *s, size_t n){
+    uint32_t h = 2166136261u;
+    for (size_t k = 0; k < n; k++)
+        h = (h ^ (unsigned char)s[k]) * 16777619u;
+    return h;
+}
+
+// Slot of s, or the empty slot where it would go
+static NameSlot *table_slot(const NameTable *t, const char *s, size_t n, uint32_t h){
+    size_t mask = t->capacity - 1;
+    size_t k = h & mask;
+    while (t->slots[k].key &&
+           (t->slots[k].hash != h || strncmp(t->slots[k].key, s, n) != 0 ||
+            t->slots[k].key[n] != '\0'))
+        k = (k + 1) & mask;
+    return &t->slots[k];
+}
+
+// Grows the table to hold count names at most half full
+static int table_reserve(NameTable *t, size_t count){
+    if (2 * count <= t->capacity)
+        return 0;
+    size_t capacity = t->capacity ? t->capacity : 1024;
+    while (2 * count > capacity)
+        capacity *= 2;
+    NameSlot *slots = calloc(capacity, sizeof(NameSlot));
+    if (!slots)
+        return -1;
+    for (size_t k = 0; k < t->capacity; k++){
+        if (!t->slots[k].key)
+            continue;
+        size_t to = t->slots[k].hash & (capacity - 1);
+        while (slots[to].key)
+            to = (to + 1) & (capacity - 1);
+        slots[to] = t->slots[k];
+    }
+    free(t->slots);
+    t->slots = slots;
+    t->capacity = capacity;
+    return 0;
+}
+
+// Value of s, missing if it is not in the table
+static int table_find(const NameTable *t, const char *s, size_t n, int missing){
+    if (!t->capacity)
+        return missing;
+    const NameSlot *slot = table_slot(t, s, n, hash_name(s, n));
+    return slot->key ? slot->value : missing;
+}
+
+// Interns s with value, returns the interned copy, s itself without an
+// arena. NULL if s is already in the table (*existing set) or out of memory
+// (*existing untouched).
+static const char *table_insert(NameTable *t, MpsArena **arena, const char *s,
+                                size_t n, int value, int *existing){
+    if (table_reserve(t, t->count + 1))
+        return NULL;
+    uint32_t h = hash_name(s, n);
+    NameSlot *slot = table_slot(t, s, n, h);
+    if (slot->key){
+        *existing = slot->value;
+        return NULL;
+    }
+    const char *key = arena ? arena_copy(arena, s, n) : s;
+    if (!key)
+        return NULL;
+    *slot = (NameSlot){key, h, value};
+    t->count++;
+    return key;
+}
+
+static void table_destroy(NameTable *t){
+    free(t->slots);
+}
+
+// Grows k parallel arrays with the given entry sizes to hold need, 0 or -1
+static int reserve(void **arrays[], const size_t sizes[], int k, int *capacity, int need){
+    if (need <= *capacity)
+        return 0;
+    int c = *capacity ? *capacity : 256;
+    while (c < need)
+        c = c > INT_MAX / 2 ? INT_MAX : 2 * c;
+    for (int a = 0; a < k; a++){
+        void *p = realloc(*arrays[a], (size_t)c * sizes[a]);
+        if (!p)
+            return -1;
+        *arrays[a] = p;
+    }
+    *capacity = c;
+    return 0;
+}
+
+typedef struct Token{
+    const char *s;
+    int n;
+}Token;
+
+typedef enum Section{
+    SECTION_NONE,
+    SECTION_NAME,
+    SECTION_OBJSENSE,
+    SECTION_ROWS,
+    SECTION_COLUMNS,
+    SECTION_RHS,
+    SECTION_RANGES,
+    SECTION_BOUNDS,
+    SECTION_ENDATA
+}Section;
+
+static const char *SECTION_NAMES[] = {"", "NAME", "OBJSENSE", "ROWS", "COLUMNS",
+                                      "RHS", "RANGES", "BOUNDS", "ENDATA"};
+
+static const Token NO_TOKEN = {"", 0};
+
+static int token_is(Token t, const char *s){
+    size_t n = strlen(s);
+    return (size_t)t.n == n && memcmp(t.s, s, n) == 0;
+}
+
+static int is_max(Token t){
+    return token_is(t, "MAX") || token_is(t, "MAXIMIZE");
+}
+
+// Inf or Infinity in any case, as MPS writers spell it
+static int is_infinity(const char *s, const char *end){
+    static const char WORD[] = "infinity";
+    size_t n = (size_t)(end - s);
+    if (n != 3 && n != 8)
+        return 0;
+    for (size_t i = 0; i < n; i++)
+        if (tolower((unsigned char)s[i]) != WORD[i])
+            return 0;
+    return 1;
+}
+
+/*
+ * Token as a double. Up to 19 significant digits with a power of ten
+ * exponent up to 22 go through Clinger's fast path, a single correctly
+ * rounded multiply or divide once the digits fit in 53 bits. Anything else
+ * is handed to strtod from a copy. Inf and Infinity, signed or not, are
+ * infinite. 0, or -1 if t is not a number.
+ */
+static int parse_number(Token t, double *out){
+    static const double POWERS[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                     1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *p = t.s;
+    const char *end = t.s + t.n;
+    int negative = 0;
+    if (p < end && (*p == '+' || *p == '-'))
+        negative = *p++ == '-';
+    if (is_infinity(p, end)){
+        *out = negative ? -INFINITY : INFINITY;
+        return 0;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    int seen = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, seen++){
+        if (digits < 19){
+            mantissa = 10 * mantissa + (uint64_t)(*p - '0');
+            digits += mantissa != 0;
+        } else
+            exponent++;
+    }
+    if (p < end && *p == '.'){
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, seen++){
+            if (digits < 19){
+                mantissa = 10 * mantissa + (uint64_t)(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (!seen)
+        return -1;
+    if (p < end && (*p == 'e' || *p == 'E' || *p == 'd' || *p == 'D')){
+        p++;
+        int sign = 1;
+        if (p < end && (*p == '+' || *p == '-'))
+            sign = *p++ == '-' ? -1 : 1;
+        if (p == end)
+            return -1;
+        int e = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+            e = e < 100000 ? 10 * e + (*p - '0') : e;
+        exponent += sign * e;
+    }
+    if (p != end)
+        return -1;
+    if (mantissa < (UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22){
+        double v = (double)mantissa;
+        v = exponent < 0 ? v / POWERS[-exponent] : v * POWERS[exponent];
+        *out = negative ? -v : v;
+        return 0;
+    }
+    char copy[64];
+    if (t.n >= (int)sizeof(copy))
+        return -1;
+    memcpy(copy, t.s, (size_t)t.n);
+    copy[t.n] = '\0';
+    for (char *c = copy; *c; c++)
+        if (*c == 'd' || *c == 'D')
+            *c = 'e';
+    *out = strtod(copy, NULL);
+    return 0;
+}
+
+// Everything built while parsing, handed to the model at the end
+typedef struct Loader{
+    const char *path;
+    const char *p;
+    const char *end;
+    long line;
+    Token tokens[MAX_TOKENS];
+    int count;
+    int header;                 // The line starts in column 1
+    MpsArena *arena;
+    NameTable row_table;
+    NameTable column_table;
+    const char *name;
+    int objective;              // An N row was seen
+    int maximize;
+    double objective_offset;
+    // Rows
+    int rows;
+    int row_capacity;
+    RowType *types;
+    double *rhs;
+    double *ranges;             // NAN for rows without a range
+    const char **row_names;
+    // Columns, compressed
+    int columns;
+    int column_capacity;
+    int *column_starts;
+    double *costs;
+    double *lower;
+    double *upper;
+    const char **column_names;
+    int nonzeros;
+    int entry_capacity;
+    int *row_indices;
+    double *values;
+}Loader;
+
+static void loader_destroy(Loader *ld){
+    table_destroy(&ld->row_table);
+    table_destroy(&ld->column_table);
+    arena_destroy(ld->arena);
+    free(ld->types);
+    free(ld->rhs);
+    free(ld->ranges);
+    free(ld->row_names);
+    free(ld->column_starts);
+    free(ld->costs);
+    free(ld->lower);
+    free(ld->upper);
+    free(ld->column_names);
+    free(ld->row_indices);
+    free(ld->values);
+}
+
+static int fail(const Loader *ld, const char *message, Token t){
+    fprintf(stderr, "Error: %s:%ld: %s%s%.*s\n", ld->path, ld->line, message,
+            t.n ? " " : "", t.n, t.s);
+    return -1;
+}
+
+static int out_of_memory(const Loader *ld){
+    fprintf(stderr, "Error: %s:%ld: out of memory.\n", ld->path, ld->line);
+    return -1;
+}
+
+/*
+ * Splits the next line that is neither blank nor a comment into tokens,
+ * pointing into the mapping. 0 at the end of the file.
+ */
+static int next_line(Loader *ld){
+    while (ld->p < ld->end){
+        const char *p = ld->p;
+        const char *eol = memchr(p, '\n', (size_t)(ld->end - p));
+        if (!eol)
+            eol = ld->end;
+        ld->p = eol + (eol < ld->end);
+        ld->line++;
+        if (*p == '*')
+            continue;
+        ld->header = *p != ' ' && *p != '\t';
+        ld->count = 0;
+        while (p < eol){
+            while (p < eol && (*p == ' ' || *p == '\t' || *p == '\r'))
+                p++;
+            if (p == eol)
+                break;
+            const char *s = p;
+            while (p < eol && *p != ' ' && *p != '\t' && *p != '\r')
+                p++;
+            if (ld->count == MAX_TOKENS){
+                fail(ld, "too many fields", (Token){s, (int)(p - s)});
+                return -1;
+            }
+            ld->tokens[ld->count++] = (Token){s, (int)(p - s)};
+        }
+        if (ld->count)
+            return 1;
+    }
+    return 0;
+}
+
+static int add_row(Loader *ld, Token type, Token name){
+    RowType row_type;
+    int existing = INT_MIN;
+    if (token_is(type, "N")){
+        // Only the first N row is the objective
+        int value = ld->objective ? FREE_ROW : OBJECTIVE_ROW;
+        if (!table_insert(&ld->row_table, &ld->arena, name.s, (size_t)name.n, value, &existing))
+            return existing != INT_MIN ? fail(ld, "duplicate row", name) : out_of_memory(ld);
+        ld->objective = 1;
+        return 0;
+    }
+    if (token_is(type, "L"))
+        row_type = ROW_LE;
+    else if (token_is(type, "G"))
+        row_type = ROW_GE;
+    else if (token_is(type, "E"))
+        row_type = ROW_EQ;
+    else
+        return fail(ld, "unknown row type", type);
+    void **arrays[] = {(void **)&ld->types, (void **)&ld->rhs, (void **)&ld->ranges,
+                       (void **)&ld->row_names};
+    const size_t sizes[] = {sizeof(RowType), sizeof(double), sizeof(double), sizeof(char *)};
+    if (reserve(arrays, sizes, 4, &ld->row_capacity, ld->rows + 1))
+        return out_of_memory(ld);
+    const char *key = table_insert(&ld->row_table, &ld->arena, name.s, (size_t)name.n,
+                                   ld->rows, &existing);
+    if (!key)
+        return existing != INT_MIN ? fail(ld, "duplicate row", name) : out_of_memory(ld);
+    ld->types[ld->rows] = row_type;
+    ld->rhs[ld->rows] = 0.0;
+    ld->ranges[ld->rows] = NAN;
+    ld->row_names[ld->rows++] = key;
+    return 0;
+}
+
+// Row of a name, fails on names that were not declared in ROWS
+static int find_row(const Loader *ld, Token name, int *row){
+    *row = table_find(&ld->row_table, name.s, (size_t)name.n, INT_MIN);
+    return *row == INT_MIN ? fail(ld, "unknown row", name) : 0;
+}
+
+// Starts a new column. Names are only interned into the table once the
+// section ends, see index_columns.
+static int begin_column(Loader *ld, Token name){
+    void **arrays[] = {(void **)&ld->column_starts, (void **)&ld->costs, (void **)&ld->lower,
+                       (void **)&ld->upper, (void **)&ld->column_names};
+    const size_t sizes[] = {sizeof(int), sizeof(double), sizeof(double), sizeof(double),
+                            sizeof(char *)};
+    // column_starts has one more entry than there are columns
+    if (ld->columns + 2 > ld->column_capacity &&
+        reserve(arrays, sizes, 5, &ld->column_capacity, ld->columns + 2))
+        return out_of_memory(ld);
+    const char *key = arena_copy(&ld->arena, name.s, (size_t)name.n);
+    if (!key)
+        return out_of_memory(ld);
+    ld->column_starts[ld->columns] = ld->nonzeros;
+    ld->costs[ld->columns] = 0.0;
+    ld->lower[ld->columns] = 0.0;
+    ld->upper[ld->columns] = INFINITY;
+    ld->column_names[ld->columns++] = key;
+    ld->column_starts[ld->columns] = ld->nonzeros;
+    return 0;
+}
+
+/*
+ * Column names -> index, built in one go after COLUMNS. Sized up front it
+ * never rehashes, and inserting the names back to back is several times
+ * cheaper than interleaving the inserts with parsing. A name seen twice
+ * means the entries of that column were not contiguous.
+ */
+static int index_columns(Loader *ld){
+    if (ld->column_table.count == (size_t)ld->columns)
+        return 0;
+    if (table_reserve(&ld->column_table, (size_t)ld->columns))
+        return out_of_memory(ld);
+    for (int j = 0; j < ld->columns; j++){
+        const char *name = ld->column_names[j];
+        int existing = INT_MIN;
+        if (!table_insert(&ld->column_table, NULL, name, strlen(name), j, &existing))
+            return existing != INT_MIN
+                       ? fail(ld, "column is not contiguous", (Token){name, (int)strlen(name)})
+                       : out_of_memory(ld);
+    }
+    return 0;
+}
+
+static int add_entry(Loader *ld, Token row_name, Token value){
+    int row;
+    double v;
+    if (find_row(ld, row_name, &row))
+        return -1;
+    if (parse_number(value, &v))
+        return fail(ld, "bad number", value);
+    if (row == OBJECTIVE_ROW){
+        ld->costs[ld->columns - 1] += v;
+        return 0;
+    }
+    if (row == FREE_ROW || v == 0.0)
+        return 0;
+    if (ld->nonzeros == INT_MAX)
+        return fail(ld, "too many nonzeros", NO_TOKEN);
+    void **arrays[] = {(void **)&ld->row_indices, (void **)&ld->values};
+    const size_t sizes[] = {sizeof(int), sizeof(double)};
+    if (ld->nonzeros == ld->entry_capacity &&
+        reserve(arrays, sizes, 2, &ld->entry_capacity, ld->nonzeros + 1))
+        return out_of_memory(ld);
+    ld->row_indices[ld->nonzeros] = row;
+    ld->values[ld->nonzeros++] = v;
+    ld->column_starts[ld->columns] = ld->nonzeros;
+    return 0;
+}
+
+static int parse_columns(Loader *ld){
+    // Integer markers: name 'MARKER' 'INTORG' or 'INTEND'
+    if (ld->count >= 2 && token_is(ld->tokens[1], "'MARKER'"))
+        return 0;
+    if (ld->count != 3 && ld->count != 5)
+        return fail(ld, "expected column row value [row value]", NO_TOKEN);
+    Token name = ld->tokens[0];
+    if (!ld->columns ||
+        strncmp(ld->column_names[ld->columns - 1], name.s, (size_t)name.n) != 0 ||
+        ld->column_names[ld->columns - 1][name.n] != '\0'){
+        if (begin_column(ld, name))
+            return -1;
+    }
+    for (int k = 1; k < ld->count; k += 2)
+        if (add_entry(ld, ld->tokens[k], ld->tokens[k + 1]))
+            return -1;
+    return 0;
+}
+
+// A BOUNDS, RHS or RANGES number, infinite from MPS_INFINITY on
+static int parse_limit(Token t, double *out){
+    if (parse_number(t, out))
+        return -1;
+    if (fabs(*out) >= MPS_INFINITY)
+        *out = *out < 0 ? -INFINITY : INFINITY;
+    return 0;
+}
+
+// RHS and RANGES lines, with or without the set name
+static int parse_row_values(Loader *ld, int ranges){
+    int first = ld->count % 2;
+    if (ld->count < 2 || ld->count > 5)
+        return fail(ld, "expected [set] row value [row value]", NO_TOKEN);
+    for (int k = first; k < ld->count; k += 2){
+        int row;
+        double v;
+        if (find_row(ld, ld->tokens[k], &row))
+            return -1;
+        if (parse_limit(ld->tokens[k + 1], &v))
+            return fail(ld, "bad number", ld->tokens[k + 1]);
+        if (row == OBJECTIVE_ROW && !ranges && isinf(v))
+            return fail(ld, "infinite objective constant", ld->tokens[k + 1]);
+        if (row >= 0 && ranges)
+            ld->ranges[row] = v;
+        else if (row >= 0)
+            ld->rhs[row] = v;
+        else if (row == OBJECTIVE_ROW && !ranges)
+            ld->objective_offset = -v;
+    }
+    return 0;
+}
+
+static int parse_bounds(Loader *ld){
+    Token *t = ld->tokens;
+    if (ld->count < 2 || ld->count > 4)
+        return fail(ld, "expected type [set] column [value]", NO_TOKEN);
+    // The set name is optional: the column is the first field after it that
+    // names a column
+    int k = 1;
+    if (ld->count >= 3 && table_find(&ld->column_table, t[2].s, (size_t)t[2].n, -1) >= 0)
+        k = 2;
+    int j = table_find(&ld->column_table, t[k].s, (size_t)t[k].n, -1);
+    if (j < 0)
+        return fail(ld, "unknown column", t[k]);
+    double v = 0.0;
+    int has_value = k + 1 < ld->count;
+    if (has_value && parse_limit(t[k + 1], &v))
+        return fail(ld, "bad number", t[k + 1]);
+    Token type = t[0];
+    if (token_is(type, "FR") || token_is(type, "MI"))
+        return fail(ld, "every variable is x >= 0, free bound on", t[k]);
+    if (token_is(type, "BV")){
+        ld->lower[j] = 0.0;
+        ld->upper[j] = 1.0;
+        return 0;
+    }
+    if (token_is(type, "PL"))
+        return 0;
+    int upper = token_is(type, "UP") || token_is(type, "UI");
+    int lower = token_is(type, "LO") || token_is(type, "LI");
+    int fixed = token_is(type, "FX");
+    if (!upper && !lower && !fixed)
+        return fail(ld, "unsupported bound type", type);
+    if (!has_value)
+        return fail(ld, "missing bound value for", t[k]);
+    // LO -inf is MI, an infinite UP leaves x unbounded above
+    if (lower && v == -INFINITY)
+        return fail(ld, "every variable is x >= 0, free bound on", t[k]);
+    if ((lower || fixed) && isinf(v))
+        return fail(ld, fixed ? "infinite fixed bound on" : "infinite lower bound on", t[k]);
+    if (v < 0)
+        return fail(ld, "every variable is x >= 0, negative bound on", t[k]);
+    if (upper || fixed)
+        ld->upper[j] = v;
+    if (lower || fixed)
+        ld->lower[j] = v;
+    return 0;
+}
+
+// Section keyword of a line starting in column 1: 1 and the section set,
+// 0 if the line is data after all, -1 if out of memory
+static int parse_header(Loader *ld, Section *section){
+    Token t = ld->tokens[0];
+    for (int s = SECTION_NAME; s <= SECTION_ENDATA; s++){
+        if (!token_is(t, SECTION_NAMES[s]))
+            continue;
+        *section = (Section)s;
+        if (s == SECTION_NAME && ld->count > 1){
+            ld->name = arena_copy(&ld->arena, ld->tokens[1].s, (size_t)ld->tokens[1].n);
+            if (!ld->name)
+                return out_of_memory(ld);
+        }
+        if (s == SECTION_OBJSENSE && ld->count > 1)
+            ld->maximize = is_max(ld->tokens[1]);
+        return 1;
+    }
+    return 0;
+}
+
+static int parse(Loader *ld){
+    Section section = SECTION_NONE;
+    int status;
+    while ((status = next_line(ld)) > 0){
+        // Free MPS may put data in column 1 too
+        int header = ld->header ? parse_header(ld, &section) : 0;
+        if (header < 0)
+            return -1;
+        if (header){
+            if (section != SECTION_COLUMNS && index_columns(ld))
+                return -1;
+            if (section == SECTION_ENDATA)
+                return 0;
+            continue;
+        }
+        switch (section){
+        case SECTION_OBJSENSE:
+            ld->maximize = is_max(ld->tokens[0]);
+            break;
+        case SECTION_ROWS:
+            if (ld->count != 2)
+                return fail(ld, "expected type name", NO_TOKEN);
+            if (add_row(ld, ld->tokens[0], ld->tokens[1]))
+                return -1;
+            break;
+        case SECTION_COLUMNS:
+            if (parse_columns(ld))
+                return -1;
+            break;
+        case SECTION_RHS:
+        case SECTION_RANGES:
+            if (parse_row_values(ld, section == SECTION_RANGES))
+                return -1;
+            break;
+        case SECTION_BOUNDS:
+            if (parse_bounds(ld))
+                return -1;
+            break;
+        case SECTION_NONE:
+            return fail(ld, "unknown section", ld->tokens[0]);
+        default:
+            return fail(ld, "unexpected line in", (Token){SECTION_NAMES[section],
+                                                          (int)strlen(SECTION_NAMES[section])});
+        }
+    }
+    if (status < 0)
+        return -1;
+    return fail(ld, "missing ENDATA", NO_TOKEN);
+}
+
+/*
+ * Range of row i as lo <= a x <= hi from its type, rhs and RANGES value.
+ * Rows with both sides finite keep the lower side and get an extra LE row.
+ */
+static void row_range(const Loader *ld, int i, double *lo, double *hi){
+    double b = ld->rhs[i];
+    double r = ld->ranges[i];
+    *lo = ld->types[i] == ROW_LE ? -INFINITY : b;
+    *hi = ld->types[i] == ROW_GE ? INFINITY : b;
+    // A range does not move an infinite rhs
+    if (isnan(r) || isinf(b))
+        return;
+    if (ld->types[i] == ROW_LE)
+        *lo = b - fabs(r);
+    else if (ld->types[i] == ROW_GE)
+        *hi = b + fabs(r);
+    else if (r > 0)
+        *hi = b + r;
+    else
+        *lo = b + r;
+}
+
+/*
+ * Turns ranges and bounds into rows, appended after the constraint rows:
+ * a two sided row is split into GE lo and LE hi, a bounded column gets
+ * x >= lower and x <= upper rows, or x == value when they agree. A row left
+ * with one finite side by an infinite rhs or range becomes LE or GE on that
+ * side, one with none loses its entries and becomes 0 <= 0. The matrix is
+ * rebuilt once with the new entries, and only when there are any.
+ */
+static int add_range_and_bound_rows(Loader *ld){
+    const int m = ld->rows;
+    int splits = 0;
+    int dropped = 0;
+    int extra_entries = 0;
+    int *split = malloc((size_t)(m ? m : 1) * sizeof(int));
+    if (!split)
+        return out_of_memory(ld);
+    for (int i = 0; i < m; i++){
+        double lo, hi;
+        row_range(ld, i, &lo, &hi);
+        split[i] = -1;
+        if (lo == INFINITY || hi == -INFINITY){
+            Token name = {ld->row_names[i], (int)strlen(ld->row_names[i])};
+            free(split);
+            return fail(ld, "infinite rhs can not be met on row", name);
+        }
+        if (lo == hi){
+            ld->types[i] = ROW_EQ;
+            ld->rhs[i] = lo;
+        } else if (isfinite(lo) && isfinite(hi))
+            split[i] = m + splits++;
+        else if (isfinite(lo) || isfinite(hi)){
+            ld->types[i] = isfinite(lo) ? ROW_GE : ROW_LE;
+            ld->rhs[i] = isfinite(lo) ? lo : hi;
+        } else {
+            split[i] = DROPPED_ROW;
+            ld->types[i] = ROW_LE;
+            ld->rhs[i] = 0.0;
+            dropped = 1;
+        }
+    }
+    int extra = splits;
+    for (int p = 0; p < ld->nonzeros; p++)
+        extra_entries += split[ld->row_indices[p]] >= 0 ? 1
+                       : -(split[ld->row_indices[p]] == DROPPED_ROW);
+    for (int j = 0; j < ld->columns; j++){
+        int rows = ld->lower[j] == ld->upper[j] ? 1
+                 : (ld->lower[j] > 0) + (ld->upper[j] < INFINITY);
+        extra += rows;
+        extra_entries += rows;
+    }
+    if (!extra && !dropped){
+        free(split);
+        return 0;
+    }
+    if ((long long)ld->nonzeros + extra_entries > INT_MAX ||
+        (long long)m + extra > INT_MAX){
+        free(split);
+        return fail(ld, "too many rows from bounds and ranges", NO_TOKEN);
+    }
+
+    void **arrays[] = {(void **)&ld->types, (void **)&ld->rhs, (void **)&ld->ranges,
+                       (void **)&ld->row_names};
+    const size_t sizes[] = {sizeof(RowType), sizeof(double), sizeof(double), sizeof(char *)};
+    const int nz = ld->nonzeros + extra_entries;
+    int *indices = malloc((size_t)(nz ? nz : 1) * sizeof(int));
+    double *values = malloc((size_t)(nz ? nz : 1) * sizeof(double));
+    if (!indices || !values || reserve(arrays, sizes, 4, &ld->row_capacity, m + extra)){
+        free(split);
+        free(indices);
+        free(values);
+        return out_of_memory(ld);
+    }
+    for (int i = 0; i < m; i++){
+        if (split[i] < 0)
+            continue;
+        double lo, hi;
+        row_range(ld, i, &lo, &hi);
+        ld->types[i] = ROW_GE;
+        ld->rhs[i] = lo;
+        ld->types[split[i]] = ROW_LE;
+        ld->rhs[split[i]] = hi;
+    }
+    int row = m + splits;
+    int to = 0;
+    for (int j = 0; j < ld->columns; j++){
+        int begin = ld->column_starts[j];
+        int end = ld->column_starts[j + 1];
+        ld->column_starts[j] = to;
+        for (int p = begin; p < end; p++){
+            int i = ld->row_indices[p];
+            if (split[i] == DROPPED_ROW)
+                continue;
+            indices[to] = i;
+            values[to++] = ld->values[p];
+            if (split[i] >= 0){
+                indices[to] = split[i];
+                values[to++] = ld->values[p];
+            }
+        }
+        double lower = ld->lower[j];
+        double upper = ld->upper[j];
+        if (lower == upper || lower > 0){
+            ld->types[row] = lower == upper ? ROW_EQ : ROW_GE;
+            ld->rhs[row] = lower;
+            indices[to] = row++;
+            values[to++] = 1.0;
+        }
+        if (upper < INFINITY && lower != upper){
+            ld->types[row] = ROW_LE;
+            ld->rhs[row] = upper;
+            indices[to] = row++;
+            values[to++] = 1.0;
+        }
+    }
+    ld->column_starts[ld->columns] = to;
+    free(split);
+    free(ld->row_indices);
+    free(ld->values);
+    ld->row_indices = indices;
+    ld->values = values;
+    ld->nonzeros = to;
+    ld->entry_capacity = nz;
+    ld->rows = row;
+    return 0;
+}
+
+// Hands the arrays over to a SparseLP and the model, ld keeps the rest
+static MpsModel *build(Loader *ld){
+    if (!ld->rows || !ld->columns){
+        fail(ld, ld->rows ? "no columns" : "no constraint rows", NO_TOKEN);
+        return NULL;
+    }
+    const int constraints = ld->rows;
+    if (add_range_and_bound_rows(ld))
+        return NULL;
+    MpsModel *model = calloc(1, sizeof(MpsModel));
+    if (!model){
+        out_of_memory(ld);
+        return NULL;
+    }
+    model->lp = sparse_create_columns(ld->rows, ld->columns, ld->types, ld->column_starts,
+                                      ld->row_indices, ld->values);
+    ld->column_starts = NULL;
+    ld->row_indices = NULL;
+    ld->values = NULL;
+    if (!model->lp){
+        free(model);
+        out_of_memory(ld);
+        return NULL;
+    }
+    for (int i = 0; i < ld->rows; i++)
+        sparse_set_b(model->lp, i, ld->rhs[i]);
+    for (int j = 0; j < ld->columns; j++)
+        sparse_set_z(model->lp, j, ld->maximize ? -ld->costs[j] : ld->costs[j]);
+    model->constraints = constraints;
+    model->row_names = ld->row_names;
+    model->column_names = ld->column_names;
+    model->name = ld->name ? ld->name : "";
+    model->objective_offset = ld->objective_offset;
+    model->maximize = ld->maximize;
+    model->arena = ld->arena;
+    ld->row_names = NULL;
+    ld->column_names = NULL;
+    ld->arena = NULL;
+    return model;
+}
+
+MpsModel *mps_load(const char *path){
+    double start = now_seconds();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0){
+        fprintf(stderr, "Error: could not open %s\n", path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size == 0){
+        fprintf(stderr, "Error: %s is empty or unreadable\n", path);
+        close(fd);
+        return NULL;
+    }
+    size_t bytes = (size_t)st.st_size;
+    void *map = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED){
+        fprintf(stderr, "Error: could not map %s\n", path);
+        return NULL;
+    }
+    posix_madvise(map, bytes, POSIX_MADV_SEQUENTIAL);
+
+    Loader ld = {0};
+    ld.path = path;
+    ld.p = map;
+    ld.end = ld.p + bytes;
+    MpsModel *model = parse(&ld) ? NULL : build(&ld);
+    munmap(map, bytes);
+    loader_destroy(&ld);
+    if (model){
+        model->bytes = bytes;
+        model->seconds = now_seconds() - start;
+    }
+    return model;
+}
+
+void mps_destroy(MpsModel *model){
+    if (!model)
+        return;
+    sparse_destroy(model->lp);
+    free(model->row_names);
+    free(model->column_names);
+    arena_destroy(model->arena);
+    free(model);
+}
+
+double mps_objective(const MpsModel *model){
+    double z = sparse_objective(model->lp);
+    return (model->maximize ? -z : z) + model->objective_offset;
+}
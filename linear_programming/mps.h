@@ -0,0 +1,54 @@
+#ifndef MPS_H
+#define MPS_H
+
+#include "revised.h"
+#include <stddef.h>
+
+typedef struct MpsArena MpsArena;
+
+/*
+ * A linear program read from an MPS file (fixed or free format, names
+ * without blanks).
+ *
+ * The file is memory mapped and parsed in one pass with no allocation per
+ * token: numbers are converted in place, names are interned once in an
+ * arena backed hash table. The COLUMNS section comes grouped by column, so
+ * its entries are appended straight into the compressed column arrays that
+ * lp then takes over (see sparse_create_columns).
+ *
+ * lp only knows x >= 0. Other bounds (UP, LO > 0, FX, BV) and RANGES become
+ * extra rows after the constraint rows; free and negative lower bounds are
+ * rejected. Values from 1e30 on and Inf or Infinity in BOUNDS, RHS and
+ * RANGES are infinite: no row for an infinite UP, and a constraint row
+ * that bounds nothing stays in lp as 0 <= 0. Integer markers are skipped,
+ * OBJSENSE MAX negates the costs.
+ */
+typedef struct MpsModel{
+    SparseLP *lp;
+    int constraints;            // Rows of the file, bound and range rows follow in lp
+    const char **row_names;     // constraints names, into the arena
+    const char **column_names;  // lp->columns names
+    const char *name;           // From the NAME line, "" if none
+    double objective_offset;    // Constant of the objective, -rhs of the objective row
+    int maximize;               // OBJSENSE MAX, lp minimizes -c
+    size_t bytes;               // File size
+    double seconds;             // Map, parse and build
+    MpsArena *arena;
+}MpsModel;
+
+/* mps_load(path) -> model
+ * Loads an MPS file. NULL on a syntax error, an unsupported bound or out of
+ * memory, with the reason and line on stderr.
+ */
+MpsModel *mps_load(const char *path);
+void mps_destroy(MpsModel *model);
+
+// Objective of the file for the current basis of lp, sense and offset included
+double mps_objective(const MpsModel *model);
+
+// Load throughput in MB/s
+static inline double mps_throughput(const MpsModel *model){
+    return model->seconds > 0 ? model->bytes / model->seconds / (1 << 20) : 0.0;
+}
+
+#endif
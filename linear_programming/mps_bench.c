@@ -0,0 +1,116 @@
+// cc -O2 mps_bench.c mps.c revised.c simplex.c simplex_data.c -lm -o mps_bench
+#define _POSIX_C_SOURCE 200809L // mkstemp, fdopen
+#include "mps.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * mps_bench [file.mps ...]
+ *
+ * Loads each file, reports the load throughput, then solves it with the
+ * sparse revised simplex. Without files it writes transportation problems
+ * in fixed MPS to a temporary file: a small one solved by both the sparse
+ * and the dense solver, and a large one that only measures the loader.
+ */
+
+// The dense tableau is only built below this size
+#define DENSE_LIMIT (16u << 20)
+
+static const char *STATUS_NAMES[] = {"optimal", "infeasible", "unbounded", "limit",
+                                     "overflow", "singular", "memory"};
+
+static uint32_t lcg(uint32_t *x){
+    *x = *x * 1664525u + 1013904223u;
+    return *x >> 8;
+}
+
+/*
+ * n suppliers, n customers, balanced supply and demand, costs 1 .. 20.
+ * Route X0_0 gets an upper bound and supplier 0 a range, so both show up.
+ */
+static void write_transport(FILE *f, int n){
+    uint32_t x = 7;
+    fprintf(f, "NAME          TRANSPORT%d\nROWS\n N  COST\n", n);
+    for (int i = 0; i < n; i++)
+        fprintf(f, " E  S%d\n", i);
+    for (int j = 0; j < n; j++)
+        fprintf(f, " E  D%d\n", j);
+    fprintf(f, "COLUMNS\n");
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            fprintf(f, "    X%d_%d  COST  %u  S%d  1\n    X%d_%d  D%d  1\n",
+                    i, j, 1 + lcg(&x) % 20, i, i, j, j);
+    fprintf(f, "RHS\n");
+    double total = 0;
+    for (int i = 0; i < n; i++){
+        unsigned supply = 10 + lcg(&x) % 90;
+        total += supply;
+        fprintf(f, "    RHS  S%d  %u\n", i, supply);
+    }
+    double left = total;
+    for (int j = 0; j < n; j++){
+        double demand = j == n - 1 ? left : floor(total / n);
+        left -= demand;
+        fprintf(f, "    RHS  D%d  %.0f\n", j, demand);
+    }
+    fprintf(f, "RANGES\n    RNG  S0  5\nBOUNDS\n UP BND  X0_0  3\nENDATA\n");
+}
+
+// Loads, reports and optionally solves one file, 0 or -1 if it did not load
+static int run(const char *name, const char *path, int solve){
+    MpsModel *model = mps_load(path);
+    if (!model)
+        return -1;
+    SparseLP *lp = model->lp;
+    printf("%-16s %8d x %-8d %9d nz %8.1f MB %8.1f ms %8.1f MB/s\n", name, lp->rows,
+           lp->columns, lp->column_starts[lp->columns], model->bytes / (double)(1 << 20),
+           model->seconds * 1e3, mps_throughput(model));
+    if (solve){
+        SimplexStatus status = sparse_solve(lp, NULL);
+        printf("%-16s sparse %-9s %16.6f %8d pivots\n", "", STATUS_NAMES[status],
+               mps_objective(model), lp->iterations);
+        double bytes = (double)lp->rows * (2.0 * lp->rows + lp->columns) * sizeof(double);
+        Tableu *t = bytes <= DENSE_LIMIT ? sparse_tableu(lp) : NULL;
+        if (t){
+            status = simplex_solve(t, NULL);
+            double z = simplex_objective(t);
+            printf("%-16s dense  %-9s %16.6f %8d pivots\n", "", STATUS_NAMES[status],
+                   (model->maximize ? -z : z) + model->objective_offset, t->iterations);
+            tableu_destroy(t);
+        }
+    }
+    mps_destroy(model);
+    return 0;
+}
+
+// Writes transport(n) to a temporary file and runs it
+static int run_transport(int n, int solve){
+    char path[] = "/tmp/mps_bench_XXXXXX";
+    int fd = mkstemp(path);
+    FILE *f = fd < 0 ? NULL : fdopen(fd, "w");
+    if (!f){
+        fprintf(stderr, "Error: could not create a temporary file.\n");
+        exit(EXIT_FAILURE);
+    }
+    write_transport(f, n);
+    fclose(f);
+    char name[32];
+    snprintf(name, sizeof(name), "transport_%d", n);
+    int result = run(name, path, solve);
+    unlink(path);
+    return result;
+}
+
+int main(int argc, char *argv[]){
+    int failures = 0;
+    for (int i = 1; i < argc; i++)
+        failures += run(argv[i], argv[i], 1) != 0;
+    if (argc > 1)
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    if (run_transport(40, 1) || run_transport(1000, 0))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,878 @@
+#include "revised.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Smallest |alpha| the ratio test pivots on
+#define PIVOT_TOLERANCE 1e-9
+// Reduced costs above -OPTIMALITY_TOLERANCE are optimal
+#define OPTIMALITY_TOLERANCE 1e-9
+// Phase I ends infeasible above this sum of artificials
+#define FEASIBILITY_TOLERANCE 1e-7
+// LU pivots at or below this are treated as singular
+#define SINGULAR_TOLERANCE 1e-11
+// LU pivots may be this much smaller than the largest entry of their column
+#define PIVOT_THRESHOLD 0.1
+#define DEFAULT_REFACTOR_INTERVAL 64
+// Degenerate pivots in a row before Dantzig pricing falls back to Bland
+#define DEGENERATE_RUN 50
+// Failures of the LU routines, which otherwise return 0 or a count
+#define LU_OUT_OF_MEMORY -1
+#define LU_SINGULAR -2
+
+/*
+ * LU factorization of the basis with product form updates.
+ *
+ * Left-looking (Gilbert-Peierls): column k of L and U comes from a sparse
+ * triangular solve with the k columns already factorized, whose nonzero
+ * pattern is found by a depth first search through L. The pivot is the entry
+ * in the sparsest row of B among those within PIVOT_THRESHOLD of the largest,
+ * which keeps fill down without giving up stability. Basis columns are taken
+ * sparsest first, so slack and artificial columns cost nothing.
+ * L U = B(perm, q): perm maps pivot steps to rows, q pivot steps to basis
+ * positions.
+ *
+ * A pivot replacing position r by a column with FTRAN image alpha appends
+ * the eta vector E = I with column r replaced by (-alpha_i / alpha_r,
+ * 1 / alpha_r at r), so the current inverse is E_k ... E_1 U^-1 L^-1.
+ */
+struct SparseLU{
+    int m;
+    int *l_starts;              // m + 1, unit diagonal first in each column
+    int *l_indices;             // Rows, in pivot order once factorized
+    double *l_values;
+    int l_capacity;
+    int *u_starts;              // m + 1, diagonal last in each column
+    int *u_indices;             // Pivot steps
+    double *u_values;
+    int u_capacity;
+    int *pinv;                  // Row -> pivot step, -1 while unpivoted
+    int *perm;                  // Pivot step -> row
+    int *q;                     // Pivot step -> basis position
+    int etas;
+    int eta_capacity;
+    int *eta_positions;         // Basis position of each eta
+    int *eta_starts;            // etas + 1
+    int *eta_indices;
+    double *eta_values;
+    int eta_entry_capacity;
+    double *x;                  // m, all zero between column solves
+    double *work;               // m
+    int *xi;                    // 2m, reach stack and pattern
+    int *marks;                 // m, visited when equal to stamp
+    int *row_counts;            // m, nonzeros of each row of the basis
+    int stamp;
+};
+
+// Grows an array of size bytes entries to hold need, 0 or -1
+static int grow(void **array, int *capacity, int need, size_t size){
+    if (need <= *capacity)
+        return 0;
+    int c = *capacity ? *capacity : 16;
+    while (c < need)
+        c *= 2;
+    void *p = realloc(*array, (size_t)c * size);
+    if (!p)
+        return -1;
+    *array = p;
+    *capacity = c;
+    return 0;
+}
+
+// Grows a pair of index and value arrays sharing a capacity
+static int grow_pair(int **indices, double **values, int *capacity, int need){
+    int c = *capacity;
+    if (grow((void **)indices, &c, need, sizeof(int)))
+        return -1;
+    c = *capacity;
+    if (grow((void **)values, &c, need, sizeof(double)))
+        return -1;
+    *capacity = c;
+    return 0;
+}
+
+static void lu_destroy(SparseLU *lu){
+    if (!lu)
+        return;
+    free(lu->l_starts);
+    free(lu->l_indices);
+    free(lu->l_values);
+    free(lu->u_starts);
+    free(lu->u_indices);
+    free(lu->u_values);
+    free(lu->pinv);
+    free(lu->perm);
+    free(lu->q);
+    free(lu->eta_positions);
+    free(lu->eta_starts);
+    free(lu->eta_indices);
+    free(lu->eta_values);
+    free(lu->x);
+    free(lu->work);
+    free(lu->xi);
+    free(lu->marks);
+    free(lu->row_counts);
+    free(lu);
+}
+
+static SparseLU *lu_create(int m){
+    SparseLU *lu = calloc(1, sizeof(SparseLU));
+    if (!lu)
+        return NULL;
+    lu->m = m;
+    lu->l_starts = malloc((size_t)(m + 1) * sizeof(int));
+    lu->u_starts = malloc((size_t)(m + 1) * sizeof(int));
+    lu->pinv = malloc((size_t)m * sizeof(int));
+    lu->perm = malloc((size_t)m * sizeof(int));
+    lu->q = malloc((size_t)m * sizeof(int));
+    lu->eta_starts = malloc(sizeof(int));
+    lu->x = calloc((size_t)m, sizeof(double));
+    lu->work = malloc((size_t)m * sizeof(double));
+    lu->xi = malloc((size_t)2 * m * sizeof(int));
+    lu->marks = calloc((size_t)m, sizeof(int));
+    lu->row_counts = malloc((size_t)m * sizeof(int));
+    if (!lu->row_counts || !lu->l_starts || !lu->u_starts || !lu->pinv || !lu->perm || !lu->q ||
+        !lu->eta_starts || !lu->x || !lu->work || !lu->xi || !lu->marks ||
+        grow_pair(&lu->l_indices, &lu->l_values, &lu->l_capacity, 4 * m) ||
+        grow_pair(&lu->u_indices, &lu->u_values, &lu->u_capacity, 4 * m)){
+        lu_destroy(lu);
+        return NULL;
+    }
+    lu->eta_starts[0] = 0;
+    return lu;
+}
+
+/*
+ * Depth first search from row j through the columns of L factorized so far,
+ * pushing finished rows on xi[top..] so they come out in topological order.
+ * Not recursive, xi[m..] is the stack of resume points.
+ */
+static int lu_dfs(SparseLU *lu, int j, int top){
+    int *stack = lu->xi;
+    int *resume = lu->xi + lu->m;
+    int head = 0;
+    stack[0] = j;
+    while (head >= 0){
+        j = stack[head];
+        int step = lu->pinv[j];
+        if (lu->marks[j] != lu->stamp){
+            lu->marks[j] = lu->stamp;
+            resume[head] = step < 0 ? 0 : lu->l_starts[step] + 1;
+        }
+        int done = 1;
+        int end = step < 0 ? 0 : lu->l_starts[step + 1];
+        for (int p = resume[head]; p < end; p++){
+            int i = lu->l_indices[p];
+            if (lu->marks[i] == lu->stamp)
+                continue;
+            resume[head] = p + 1;
+            stack[++head] = i;
+            done = 0;
+            break;
+        }
+        if (done){
+            head--;
+            stack[--top] = j;
+        }
+    }
+    return top;
+}
+
+/*
+ * x = L \ A(:, column) with L in row numbering, the nonzero pattern in
+ * xi[top..m-1]. The search stack shares xi with the pattern; it stays below
+ * top since the pattern plus the stack never exceed m rows.
+ */
+static int lu_solve_column(SparseLU *lu, const SparseLP *lp, int column){
+    const int m = lu->m;
+    int top = m;
+    lu->stamp++;
+    for (int p = lp->column_starts[column]; p < lp->column_starts[column + 1]; p++){
+        int i = lp->row_indices[p];
+        if (lu->marks[i] != lu->stamp)
+            top = lu_dfs(lu, i, top);
+    }
+    for (int p = lp->column_starts[column]; p < lp->column_starts[column + 1]; p++)
+        lu->x[lp->row_indices[p]] += lp->values[p];
+    for (int px = top; px < m; px++){
+        int j = lu->xi[px];
+        int step = lu->pinv[j];
+        if (step < 0)
+            continue;
+        double xj = lu->x[j];
+        for (int p = lu->l_starts[step] + 1; p < lu->l_starts[step + 1]; p++)
+            lu->x[lu->l_indices[p]] -= lu->l_values[p] * xj;
+    }
+    return top;
+}
+
+// Factorizes the column at basis position pos as pivot step k. 0, 1 if it
+// has no usable pivot among the unpivoted rows (nothing is kept then), or
+// LU_OUT_OF_MEMORY.
+static int lu_factor_column(SparseLU *lu, const SparseLP *lp, int pos, int k){
+    const int m = lu->m;
+    int l_size = lu->l_starts[k];
+    int u_size = lu->u_starts[k];
+    if (grow_pair(&lu->l_indices, &lu->l_values, &lu->l_capacity, l_size + m) ||
+        grow_pair(&lu->u_indices, &lu->u_values, &lu->u_capacity, u_size + m))
+        return LU_OUT_OF_MEMORY;
+    const int v = lp->basis_headers[pos];
+    int top = lu_solve_column(lu, lp, v);
+    double largest = SINGULAR_TOLERANCE;
+    for (int p = top; p < m; p++){
+        int i = lu->xi[p];
+        if (lu->pinv[i] < 0)
+            largest = fmax(largest, fabs(lu->x[i]));
+        else if (lu->x[i] != 0.0){
+            lu->u_indices[u_size] = lu->pinv[i];
+            lu->u_values[u_size++] = lu->x[i];
+        }
+    }
+    // Threshold pivoting: the sparsest row among the large enough entries
+    int ipiv = -1;
+    for (int p = top; p < m; p++){
+        int i = lu->xi[p];
+        if (lu->pinv[i] < 0 && fabs(lu->x[i]) >= PIVOT_THRESHOLD * largest &&
+            fabs(lu->x[i]) > SINGULAR_TOLERANCE &&
+            (ipiv < 0 || lu->row_counts[i] < lu->row_counts[ipiv]))
+            ipiv = i;
+    }
+    if (ipiv < 0){
+        for (int p = top; p < m; p++)
+            lu->x[lu->xi[p]] = 0.0;
+        return 1;
+    }
+    double pivot = lu->x[ipiv];
+    lu->u_indices[u_size] = k;
+    lu->u_values[u_size++] = pivot;
+    lu->pinv[ipiv] = k;
+    lu->perm[k] = ipiv;
+    lu->q[k] = pos;
+    lu->l_indices[l_size] = ipiv;
+    lu->l_values[l_size++] = 1.0;
+    for (int p = top; p < m; p++){
+        int i = lu->xi[p];
+        if (lu->pinv[i] < 0 && lu->x[i] != 0.0){
+            lu->l_indices[l_size] = i;
+            lu->l_values[l_size++] = lu->x[i] / pivot;
+        }
+        lu->x[i] = 0.0;
+    }
+    lu->l_starts[k + 1] = l_size;
+    lu->u_starts[k + 1] = u_size;
+    return 0;
+}
+
+static int artificial_begin(const SparseLP *lp){
+    return lp->columns + lp->slacks;
+}
+
+// Slack column of row i, -1 for equality rows
+static int slack_of(const SparseLP *lp, int row){
+    if (lp->row_types[row] == ROW_EQ)
+        return -1;
+    int j = lp->columns;
+    for (int i = 0; i < row; i++)
+        j += lp->row_types[i] != ROW_EQ;
+    return j;
+}
+
+static void set_basic(SparseLP *lp, int pos, int variable){
+    lp->basis_position[lp->basis_headers[pos]] = -1;
+    lp->basis_headers[pos] = variable;
+    lp->basis_position[variable] = pos;
+}
+
+/*
+ * Factorizes the current basis from scratch and drops the etas. Columns
+ * without a pivot are replaced by the slack or artificial of a row left
+ * unpivoted, which always factorizes. The number of columns replaced, or
+ * LU_OUT_OF_MEMORY, or LU_SINGULAR if the repair runs out of columns.
+ */
+static int lu_factorize(SparseLU *lu, SparseLP *lp){
+    const int m = lu->m;
+    lu->etas = 0;
+    lu->eta_starts[0] = 0;
+    lu->l_starts[0] = 0;
+    lu->u_starts[0] = 0;
+    for (int i = 0; i < m; i++)
+        lu->pinv[i] = -1;
+
+    // Positions by column count, counting sort
+    int *failed = malloc((size_t)m * sizeof(int));
+    int *counts = calloc((size_t)m + 2, sizeof(int));
+    if (!failed || !counts){
+        free(failed);
+        free(counts);
+        return LU_OUT_OF_MEMORY;
+    }
+    for (int i = 0; i < m; i++)
+        lu->row_counts[i] = 0;
+    for (int pos = 0; pos < m; pos++){
+        int v = lp->basis_headers[pos];
+        int c = lp->column_starts[v + 1] - lp->column_starts[v];
+        counts[(c < m ? c : m) + 1]++;
+        for (int p = lp->column_starts[v]; p < lp->column_starts[v + 1]; p++)
+            lu->row_counts[lp->row_indices[p]]++;
+    }
+    for (int c = 0; c <= m; c++)
+        counts[c + 1] += counts[c];
+    int *positions = malloc((size_t)m * sizeof(int));
+    if (!positions){
+        free(failed);
+        free(counts);
+        return LU_OUT_OF_MEMORY;
+    }
+    for (int pos = 0; pos < m; pos++){
+        int v = lp->basis_headers[pos];
+        int c = lp->column_starts[v + 1] - lp->column_starts[v];
+        positions[counts[c < m ? c : m]++] = pos;
+    }
+    free(counts);
+
+    int k = 0;
+    int failures = 0;
+    int result = 0;
+    for (int n = 0; n < m && result == 0; n++){
+        result = lu_factor_column(lu, lp, positions[n], k);
+        if (result == 0)
+            k++;
+        else if (result > 0){
+            failed[failures++] = positions[n];
+            result = 0;
+        }
+    }
+    // Basis repair: a unit column on each row left without a pivot
+    int row = 0;
+    for (int f = 0; f < failures && result == 0; f++){
+        while (row < m && lu->pinv[row] >= 0)
+            row++;
+        int slack = slack_of(lp, row);
+        int artificial = artificial_begin(lp) + row;
+        int variable = lp->basis_position[artificial] < 0 ? artificial
+                     : slack >= 0 && lp->basis_position[slack] < 0 ? slack : -1;
+        if (variable < 0){
+            result = LU_SINGULAR;
+            break;
+        }
+        set_basic(lp, failed[f], variable);
+        result = lu_factor_column(lu, lp, failed[f], k);
+        if (result == 0)
+            k++;
+        else if (result > 0)
+            result = LU_SINGULAR;
+    }
+    free(failed);
+    free(positions);
+    // L rows into pivot order for the solves
+    for (int p = 0; p < lu->l_starts[k]; p++)
+        lu->l_indices[p] = lu->pinv[lu->l_indices[p]];
+    lp->refactorizations++;
+    return result < 0 ? result : failures;
+}
+
+// FTRAN: out = B^-1 rhs, rhs dense by row, out by basis position
+static void lu_ftran(SparseLU *lu, const double *rhs, double *out){
+    const int m = lu->m;
+    double *w = lu->work;
+    for (int i = 0; i < m; i++)
+        w[lu->pinv[i]] = rhs[i];
+    for (int k = 0; k < m; k++){
+        double wk = w[k];
+        if (wk == 0.0)
+            continue;
+        for (int p = lu->l_starts[k] + 1; p < lu->l_starts[k + 1]; p++)
+            w[lu->l_indices[p]] -= lu->l_values[p] * wk;
+    }
+    for (int k = m - 1; k >= 0; k--){
+        if (w[k] == 0.0)
+            continue;
+        int last = lu->u_starts[k + 1] - 1;
+        double wk = w[k] /= lu->u_values[last];
+        for (int p = lu->u_starts[k]; p < last; p++)
+            w[lu->u_indices[p]] -= lu->u_values[p] * wk;
+    }
+    for (int k = 0; k < m; k++)
+        out[lu->q[k]] = w[k];
+    for (int e = 0; e < lu->etas; e++){
+        int r = lu->eta_positions[e];
+        double xr = out[r];
+        if (xr == 0.0)
+            continue;
+        out[r] = 0.0;
+        for (int p = lu->eta_starts[e]; p < lu->eta_starts[e + 1]; p++)
+            out[lu->eta_indices[p]] += lu->eta_values[p] * xr;
+    }
+}
+
+// BTRAN: out = B^-T c, c by basis position (overwritten), out dense by row
+static void lu_btran(SparseLU *lu, double *c, double *out){
+    const int m = lu->m;
+    double *w = lu->work;
+    for (int e = lu->etas - 1; e >= 0; e--){
+        double s = 0.0;
+        for (int p = lu->eta_starts[e]; p < lu->eta_starts[e + 1]; p++)
+            s += lu->eta_values[p] * c[lu->eta_indices[p]];
+        c[lu->eta_positions[e]] = s;
+    }
+    for (int k = 0; k < m; k++)
+        w[k] = c[lu->q[k]];
+    for (int k = 0; k < m; k++){
+        int last = lu->u_starts[k + 1] - 1;
+        double s = w[k];
+        for (int p = lu->u_starts[k]; p < last; p++)
+            s -= lu->u_values[p] * w[lu->u_indices[p]];
+        w[k] = s / lu->u_values[last];
+    }
+    for (int k = m - 1; k >= 0; k--){
+        double s = w[k];
+        for (int p = lu->l_starts[k] + 1; p < lu->l_starts[k + 1]; p++)
+            s -= lu->l_values[p] * w[lu->l_indices[p]];
+        w[k] = s;
+    }
+    for (int k = 0; k < m; k++)
+        out[lu->perm[k]] = w[k];
+}
+
+// Appends the eta of a pivot on position r with FTRAN image alpha
+static int lu_add_eta(SparseLU *lu, int r, const double *alpha){
+    const int m = lu->m;
+    int size = lu->eta_starts[lu->etas];
+    int c = lu->eta_capacity;
+    if (grow((void **)&lu->eta_positions, &c, lu->etas + 2, sizeof(int)))
+        return -1;
+    c = lu->eta_capacity;
+    if (grow((void **)&lu->eta_starts, &c, lu->etas + 2, sizeof(int)))
+        return -1;
+    lu->eta_capacity = c;
+    if (grow_pair(&lu->eta_indices, &lu->eta_values, &lu->eta_entry_capacity, size + m))
+        return -1;
+    double inverse = 1.0 / alpha[r];
+    for (int i = 0; i < m; i++){
+        if (alpha[i] == 0.0)
+            continue;
+        lu->eta_indices[size] = i;
+        lu->eta_values[size++] = i == r ? inverse : -alpha[i] * inverse;
+    }
+    lu->eta_positions[lu->etas++] = r;
+    lu->eta_starts[lu->etas] = size;
+    return 0;
+}
+
+SparseLP *sparse_create(int rows, int columns, const RowType *row_types, int nonzeros){
+    if (rows <= 0 || columns <= 0)
+        return NULL;
+    SparseLP *lp = calloc(1, sizeof(SparseLP));
+    if (!lp)
+        return NULL;
+    lp->rows = rows;
+    lp->columns = columns;
+    for (int i = 0; i < rows; i++)
+        lp->slacks += row_types[i] != ROW_EQ;
+    lp->total = columns + lp->slacks + rows;
+    lp->refactor_interval = DEFAULT_REFACTOR_INTERVAL;
+    lp->row_types = malloc((size_t)rows * sizeof(RowType));
+    lp->z_vector = calloc((size_t)columns, sizeof(double));
+    lp->b_vector = calloc((size_t)rows, sizeof(double));
+    lp->basis_headers = malloc((size_t)rows * sizeof(int));
+    lp->basis_position = malloc((size_t)lp->total * sizeof(int));
+    lp->x_basic = calloc((size_t)rows, sizeof(double));
+    if (!lp->row_types || !lp->z_vector || !lp->b_vector || !lp->basis_headers ||
+        !lp->basis_position || !lp->x_basic ||
+        grow_pair(&lp->row_indices, &lp->values, &lp->capacity,
+                  nonzeros > 0 ? nonzeros : 16) ||
+        !(lp->entry_columns = malloc((size_t)lp->capacity * sizeof(int)))){
+        sparse_destroy(lp);
+        return NULL;
+    }
+    memcpy(lp->row_types, row_types, (size_t)rows * sizeof(RowType));
+    return lp;
+}
+
+void sparse_destroy(SparseLP *lp){
+    if (!lp)
+        return;
+    free(lp->row_types);
+    free(lp->z_vector);
+    free(lp->b_vector);
+    free(lp->column_starts);
+    free(lp->row_indices);
+    free(lp->values);
+    free(lp->entry_columns);
+    free(lp->basis_headers);
+    free(lp->basis_position);
+    free(lp->x_basic);
+    lu_destroy(lp->lu);
+    free(lp);
+}
+
+int sparse_add(SparseLP *lp, int i, int j, double v){
+    if (lp->compressed)
+        return -1;
+    if (lp->nonzeros == lp->capacity){
+        int c = lp->capacity;
+        if (grow((void **)&lp->entry_columns, &c, lp->nonzeros + 1, sizeof(int)) ||
+            grow_pair(&lp->row_indices, &lp->values, &lp->capacity, lp->nonzeros + 1))
+            return -1;
+    }
+    lp->row_indices[lp->nonzeros] = i;
+    lp->values[lp->nonzeros] = v;
+    lp->entry_columns[lp->nonzeros++] = j;
+    return 0;
+}
+
+// Writes the slack and artificial columns after the nz entries of A, with
+// room for them in indices and values and for total + 1 starts
+static void append_unit_columns(SparseLP *lp, int *starts, int *indices,
+                                double *values, int nz){
+    int to = nz;
+    int slack = lp->columns;
+    for (int i = 0; i < lp->rows; i++){
+        if (lp->row_types[i] == ROW_EQ)
+            continue;
+        starts[slack++] = to;
+        indices[to] = i;
+        values[to++] = lp->row_types[i] == ROW_LE ? 1.0 : -1.0;
+    }
+    for (int i = 0; i < lp->rows; i++){
+        starts[artificial_begin(lp) + i] = to;
+        indices[to] = i;
+        values[to++] = 1.0;
+    }
+    starts[lp->total] = to;
+}
+
+// Sorts the entries into columns (stable counting sort) and appends the
+// slack and artificial columns
+static int compress(SparseLP *lp){
+    const int nz = lp->nonzeros;
+    const int total_nz = nz + lp->slacks + lp->rows;
+    int *starts = calloc((size_t)lp->total + 2, sizeof(int));
+    int *indices = malloc((size_t)total_nz * sizeof(int));
+    double *values = malloc((size_t)total_nz * sizeof(double));
+    if (!starts || !indices || !values){
+        free(starts);
+        free(indices);
+        free(values);
+        return -1;
+    }
+    for (int p = 0; p < nz; p++)
+        starts[lp->entry_columns[p] + 2]++;
+    for (int j = 0; j < lp->columns; j++)
+        starts[j + 2] += starts[j + 1];
+    for (int p = 0; p < nz; p++){
+        int to = starts[lp->entry_columns[p] + 1]++;
+        indices[to] = lp->row_indices[p];
+        values[to] = lp->values[p];
+    }
+    append_unit_columns(lp, starts, indices, values, nz);
+    free(lp->row_indices);
+    free(lp->values);
+    free(lp->entry_columns);
+    lp->entry_columns = NULL;
+    lp->column_starts = starts;
+    lp->row_indices = indices;
+    lp->values = values;
+    lp->compressed = 1;
+    return 0;
+}
+
+SparseLP *sparse_create_columns(int rows, int columns, const RowType *row_types,
+                                int *column_starts, int *row_indices, double *values){
+    SparseLP *lp = sparse_create(rows, columns, row_types, 1);
+    if (!lp){
+        free(column_starts);
+        free(row_indices);
+        free(values);
+        return NULL;
+    }
+    free(lp->row_indices);
+    free(lp->values);
+    free(lp->entry_columns);
+    lp->entry_columns = NULL;
+    lp->column_starts = column_starts;
+    lp->row_indices = row_indices;
+    lp->values = values;
+    lp->compressed = 1;
+    const int nz = column_starts[columns];
+    const int total_nz = nz + lp->slacks + rows;
+    int *starts = realloc(column_starts, ((size_t)lp->total + 1) * sizeof(int));
+    if (starts)
+        lp->column_starts = starts;
+    int *indices = realloc(row_indices, (size_t)total_nz * sizeof(int));
+    if (indices)
+        lp->row_indices = indices;
+    double *grown = realloc(values, (size_t)total_nz * sizeof(double));
+    if (grown)
+        lp->values = grown;
+    if (!starts || !indices || !grown){
+        sparse_destroy(lp);
+        return NULL;
+    }
+    lp->nonzeros = nz;
+    lp->capacity = total_nz;
+    append_unit_columns(lp, starts, indices, grown, nz);
+    return lp;
+}
+
+Tableu *sparse_tableu(SparseLP *lp){
+    if (!lp->compressed && compress(lp))
+        return NULL;
+    Tableu *t = tableu_create(lp->rows, lp->columns, lp->row_types);
+    if (!t)
+        return NULL;
+    for (int j = 0; j < lp->columns; j++)
+        for (int p = lp->column_starts[j]; p < lp->column_starts[j + 1]; p++)
+            tableu_row(t, lp->row_indices[p])[j] += lp->values[p];
+    for (int i = 0; i < lp->rows; i++)
+        tableu_set_b(t, i, lp->b_vector[i]);
+    for (int j = 0; j < lp->columns; j++)
+        tableu_set_z(t, j, lp->z_vector[j]);
+    return t;
+}
+
+// y . A(:, j)
+static double column_dot(const SparseLP *lp, const double *y, int j){
+    double s = 0.0;
+    for (int p = lp->column_starts[j]; p < lp->column_starts[j + 1]; p++)
+        s += y[lp->row_indices[p]] * lp->values[p];
+    return s;
+}
+
+// Work vectors of one solve, m each
+typedef struct Work{
+    double *y;                  // Duals by row
+    double *c;                  // Basic costs by position
+    double *alpha;              // FTRAN image by position
+    double *column;             // Dense column by row, zero between uses
+}Work;
+
+// alpha = B^-1 A(:, j)
+static void ftran_column(SparseLP *lp, Work *w, int j){
+    for (int p = lp->column_starts[j]; p < lp->column_starts[j + 1]; p++)
+        w->column[lp->row_indices[p]] += lp->values[p];
+    lu_ftran(lp->lu, w->column, w->alpha);
+    for (int p = lp->column_starts[j]; p < lp->column_starts[j + 1]; p++)
+        w->column[lp->row_indices[p]] = 0.0;
+}
+
+// Factorizes the basis and recomputes x_B. The number of columns the
+// repair replaced, or an LU failure.
+static int refactorize(SparseLP *lp){
+    int repaired = lu_factorize(lp->lu, lp);
+    if (repaired >= 0)
+        lu_ftran(lp->lu, lp->b_vector, lp->x_basic);
+    return repaired;
+}
+
+static SimplexStatus lu_status(int failure){
+    return failure == LU_OUT_OF_MEMORY ? SIMPLEX_OUT_OF_MEMORY : SIMPLEX_SINGULAR;
+}
+
+// Pivots q into position r, theta along alpha. 0 or an LU failure. A
+// refactorization that has to repair the basis fails with LU_SINGULAR: the
+// slack or artificial it swaps in moves x_B to wherever B^-1 b lands, which
+// need not be feasible, and the solve would carry on from there as if it
+// were.
+static int pivot(SparseLP *lp, Work *w, int r, int q){
+    double theta = fmax(lp->x_basic[r], 0.0) / w->alpha[r];
+    for (int pos = 0; pos < lp->rows; pos++)
+        lp->x_basic[pos] -= theta * w->alpha[pos];
+    lp->x_basic[r] = theta;
+    set_basic(lp, r, q);
+    lp->iterations++;
+    if (lp->lu->etas + 1 >= lp->refactor_interval){
+        int repaired = refactorize(lp);
+        return repaired > 0 ? LU_SINGULAR : repaired;
+    }
+    return lu_add_eta(lp->lu, r, w->alpha) ? LU_OUT_OF_MEMORY : 0;
+}
+
+// Entering column, -1 if the basis is optimal for costs
+static int price(SparseLP *lp, Work *w, const double *costs, Pricing pricing){
+    for (int pos = 0; pos < lp->rows; pos++)
+        w->c[pos] = costs[lp->basis_headers[pos]];
+    lu_btran(lp->lu, w->c, w->y);
+    int best = -1;
+    double best_d = -OPTIMALITY_TOLERANCE;
+    const int end = artificial_begin(lp);
+    for (int j = 0; j < end; j++){
+        if (lp->basis_position[j] >= 0)
+            continue;
+        double d = costs[j] - column_dot(lp, w->y, j);
+        if (d < best_d){
+            best = j;
+            if (pricing == PRICING_BLAND)
+                break;
+            best_d = d;
+        }
+    }
+    return best;
+}
+
+// Leaving position for alpha, ties to the lowest basic variable, -1 if none
+static int ratio_test(const SparseLP *lp, const Work *w, double *ratio){
+    int best = -1;
+    double best_ratio = 0.0;
+    for (int pos = 0; pos < lp->rows; pos++){
+        double a = w->alpha[pos];
+        if (a <= PIVOT_TOLERANCE)
+            continue;
+        double r = fmax(lp->x_basic[pos], 0.0) / a;
+        if (best < 0 || r < best_ratio - 1e-12 ||
+            (r <= best_ratio + 1e-12 &&
+             lp->basis_headers[pos] < lp->basis_headers[best])){
+            best = pos;
+            best_ratio = r;
+        }
+    }
+    *ratio = best_ratio;
+    return best;
+}
+
+static SimplexStatus iterate(SparseLP *lp, Work *w, const double *costs,
+                             Pricing pricing, int max_iterations){
+    int degenerate = 0;
+    while (lp->iterations < max_iterations){
+        Pricing rule = pricing == PRICING_BLAND || degenerate >= DEGENERATE_RUN
+                           ? PRICING_BLAND : PRICING_DANTZIG;
+        int q = price(lp, w, costs, rule);
+        if (q < 0)
+            return SIMPLEX_OPTIMAL;
+        ftran_column(lp, w, q);
+        double ratio;
+        int r = ratio_test(lp, w, &ratio);
+        if (r < 0)
+            return SIMPLEX_UNBOUNDED;
+        degenerate = ratio <= 1e-12 ? degenerate + 1 : 0;
+        int failure = pivot(lp, w, r, q);
+        if (failure)
+            return lu_status(failure);
+    }
+    return SIMPLEX_ITERATION_LIMIT;
+}
+
+// Pivots artificials left basic at zero out for any other column with a
+// nonzero in their row of B^-1 A. Rows without one are redundant. 0 or the
+// LU failure of a pivot.
+static int drive_out_artificials(SparseLP *lp, Work *w){
+    const int art = artificial_begin(lp);
+    for (int r = 0; r < lp->rows; r++){
+        if (lp->basis_headers[r] < art)
+            continue;
+        memset(w->c, 0, (size_t)lp->rows * sizeof(double));
+        w->c[r] = 1.0;
+        lu_btran(lp->lu, w->c, w->y);
+        for (int j = 0; j < art; j++){
+            if (lp->basis_position[j] >= 0 || fabs(column_dot(lp, w->y, j)) <= PIVOT_TOLERANCE)
+                continue;
+            ftran_column(lp, w, j);
+            int failure = pivot(lp, w, r, j);
+            if (failure)
+                return failure;
+            break;
+        }
+    }
+    return 0;
+}
+
+SimplexStatus sparse_solve(SparseLP *lp, const SimplexOptions *options){
+    if (!options)
+        options = &SIMPLEX_DEFAULTS;
+    int max_iterations = options->max_iterations;
+    if (max_iterations <= 0)
+        max_iterations = 50 * (lp->rows + lp->total);
+    const int m = lp->rows;
+    const int art = artificial_begin(lp);
+    lp->iterations = 0;
+    lp->phase1_iterations = 0;
+    lp->refactorizations = 0;
+    if (!lp->compressed && compress(lp))
+        return SIMPLEX_OUT_OF_MEMORY;
+    if (!lp->lu && !(lp->lu = lu_create(m)))
+        return SIMPLEX_OUT_OF_MEMORY;
+
+    // Artificials take the sign of b, slacks start basic where b allows
+    int slack = lp->columns;
+    for (int j = 0; j < lp->total; j++)
+        lp->basis_position[j] = -1;
+    for (int i = 0; i < m; i++){
+        double sign = lp->b_vector[i] < 0 ? -1.0 : 1.0;
+        lp->values[lp->column_starts[art + i]] = sign;
+        int variable = art + i;
+        if (lp->row_types[i] != ROW_EQ){
+            double coefficient = lp->row_types[i] == ROW_LE ? 1.0 : -1.0;
+            if (coefficient * lp->b_vector[i] >= 0)
+                variable = slack;
+            slack++;
+        }
+        lp->basis_headers[i] = variable;
+        lp->basis_position[variable] = i;
+    }
+
+    Work w;
+    double *block = calloc((size_t)4 * m + lp->total, sizeof(double));
+    if (!block)
+        return SIMPLEX_OUT_OF_MEMORY;
+    w.y = block;
+    w.c = block + m;
+    w.alpha = block + 2 * m;
+    w.column = block + 3 * m;
+    double *costs = block + 4 * m;
+    // The start basis is unit columns, a repair here only picks others
+    int repaired = refactorize(lp);
+    if (repaired < 0){
+        free(block);
+        return lu_status(repaired);
+    }
+
+    // Phase I: minimize the sum of the artificials
+    SimplexStatus status = SIMPLEX_OPTIMAL;
+    int artificials = 0;
+    for (int i = 0; i < m; i++){
+        costs[art + i] = 1.0;
+        artificials += lp->basis_headers[i] >= art;
+    }
+    if (artificials){
+        status = iterate(lp, &w, costs, options->pricing, max_iterations);
+        lp->phase1_iterations = lp->iterations;
+        double infeasibility = 0.0;
+        for (int pos = 0; pos < m; pos++)
+            if (lp->basis_headers[pos] >= art)
+                infeasibility += fmax(lp->x_basic[pos], 0.0);
+        if (status == SIMPLEX_OPTIMAL && infeasibility > FEASIBILITY_TOLERANCE)
+            status = SIMPLEX_INFEASIBLE;
+        int failure = status == SIMPLEX_OPTIMAL ? drive_out_artificials(lp, &w) : 0;
+        if (failure)
+            status = lu_status(failure);
+    }
+
+    // Phase II: the real costs
+    if (status == SIMPLEX_OPTIMAL){
+        for (int j = 0; j < lp->total; j++)
+            costs[j] = j < lp->columns ? lp->z_vector[j] : 0.0;
+        status = iterate(lp, &w, costs, options->pricing, max_iterations);
+    }
+    free(block);
+    return status;
+}
+
+double sparse_objective(const SparseLP *lp){
+    double z = 0.0;
+    for (int pos = 0; pos < lp->rows; pos++){
+        int j = lp->basis_headers[pos];
+        if (j < lp->columns)
+            z += lp->z_vector[j] * lp->x_basic[pos];
+    }
+    return z;
+}
+
+void sparse_solution(const SparseLP *lp, double *x){
+    for (int j = 0; j < lp->columns; j++)
+        x[j] = 0.0;
+    for (int pos = 0; pos < lp->rows; pos++){
+        int j = lp->basis_headers[pos];
+        if (j < lp->columns)
+            x[j] = lp->x_basic[pos];
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef REVISED_H
+#define REVISED_H
+
+#include "simplex.h"
+
+typedef struct SparseLU SparseLU;
+
+/*
+ * Sparse revised simplex for
+ *
+ *   minimize z^T x  subject to  A x (<=, >=, ==) b,  x >= 0
+ *
+ * A is stored by columns (CSC) next to one slack per inequality row and one
+ * artificial per row, the same column layout as Tableu. Nothing of size
+ * rows x columns is ever formed: the basis is kept as a sparse LU
+ * factorization plus a file of eta vectors, one per pivot (product form),
+ * and refactorized every refactor_interval pivots. Each iteration is a
+ * BTRAN for the duals, pricing over the columns, and an FTRAN for the
+ * entering column, so memory and time follow the nonzeros.
+ *
+ * Fill the matrix with sparse_add in any order (column order is cheapest),
+ * entries at the same position add up. It is compressed on the first solve.
+ */
+typedef struct SparseLP{
+    int rows;                   // m
+    int columns;                // n structural variables
+    int slacks;                 // Inequality rows
+    int total;                  // columns + slacks + rows
+    RowType *row_types;
+    double *z_vector;           // c, n costs
+    double *b_vector;           // b
+    int nonzeros;               // Entries of A
+    int capacity;
+    int *column_starts;         // total + 1 once compressed
+    int *row_indices;
+    double *values;
+    int *entry_columns;         // Column of each entry until compressed
+    int compressed;
+    int *basis_headers;         // Basic variable at each basis position
+    int *basis_position;        // Position of each variable, -1 if nonbasic
+    double *x_basic;            // Values of the basic variables
+    SparseLU *lu;
+    int refactor_interval;      // Pivots between refactorizations
+    int iterations;             // Pivots of the last solve, both phases
+    int phase1_iterations;
+    int refactorizations;
+}SparseLP;
+
+/* sparse_create(rows, columns, row_types, nonzeros) -> lp
+ * Empty sparse LP, nonzeros is a capacity hint. NULL if out of memory.
+ */
+SparseLP *sparse_create(int rows, int columns, const RowType *row_types, int nonzeros);
+/* sparse_create_columns(rows, columns, row_types, column_starts, row_indices, values) -> lp
+ * Sparse LP over an A already in compressed columns: column j is entries
+ * column_starts[j] .. column_starts[j + 1] - 1. Takes over the three arrays,
+ * which must come from malloc, and grows them for the slack and artificial
+ * columns. sparse_add refuses entries. NULL if out of memory, the arrays are
+ * freed then too.
+ */
+SparseLP *sparse_create_columns(int rows, int columns, const RowType *row_types,
+                                int *column_starts, int *row_indices, double *values);
+void sparse_destroy(SparseLP *lp);
+// A[i][j] += v, 0 or -1 if out of memory
+int sparse_add(SparseLP *lp, int i, int j, double v);
+static inline void sparse_set_b(SparseLP *lp, int i, double v){
+    lp->b_vector[i] = v;
+}
+static inline void sparse_set_z(SparseLP *lp, int j, double v){
+    lp->z_vector[j] = v;
+}
+
+/* sparse_solve(lp, options) -> status
+ * Two phase primal revised simplex, Dantzig or Bland pricing (steepest edge
+ * and devex price like Dantzig). SIMPLEX_SINGULAR if a basis can not be factorized
+ * without repair after the start, SIMPLEX_OUT_OF_MEMORY if the work arrays or
+ * the LU can not be allocated.
+ */
+SimplexStatus sparse_solve(SparseLP *lp, const SimplexOptions *options);
+/* sparse_tableu(lp) -> tableu
+ * The same LP as a dense Tableu for simplex_solve, compressing lp first if
+ * needed. NULL if out of memory.
+ */
+Tableu *sparse_tableu(SparseLP *lp);
+// z^T x of the current basis
+double sparse_objective(const SparseLP *lp);
+// Values of the n structural variables of the current basis
+void sparse_solution(const SparseLP *lp, double *x);
+
+#endif
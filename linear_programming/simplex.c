@@ -0,0 +1,734 @@
+#include "simplex.h"
+#include <math.h>
+#include <stdlib.h>
+#ifdef SIMPLEX_THREADS
+#include "workstealing.h"
+#endif
+
+const SimplexOptions SIMPLEX_DEFAULTS = {PRICING_DANTZIG, 0, 0, 0};
+
+// Entries below this are zero, reduced costs above -EPSILON are optimal
+#define SIMPLEX_EPSILON 1e-9
+// Degenerate pivots in a row before Dantzig pricing falls back to Bland
+#define DEGENERATE_RUN 50
+// Most blocks a step is split into, and the smallest block in columns or rows
+#define MAX_BLOCKS 64
+#define COLUMN_GRAIN 512
+#define ROW_GRAIN 8
+// Tableau doubles (rows x stride) below which a parallel solve runs serially
+#define PARALLEL_MIN_WORK (1 << 16)
+
+/*
+ * Row kernels. Rows are aligned and padded with zeros to the stride, so the
+ * loops run over whole rows without remainders and vectorize.
+ */
+
+// y += a * x
+static void row_axpy(double *restrict y, const double *restrict x, double a, size_t n){
+    y = __builtin_assume_aligned(y, 64);
+    x = __builtin_assume_aligned(x, 64);
+    for (size_t k = 0; k < n; k++)
+        y[k] += a * x[k];
+}
+
+// y *= a
+static void row_scale(double *restrict y, double a, size_t n){
+    y = __builtin_assume_aligned(y, 64);
+    for (size_t k = 0; k < n; k++)
+        y[k] *= a;
+}
+
+// First artificial column
+static int artificial_begin(const Tableu *t){
+    return t->columns + t->slacks;
+}
+
+/*
+ * Blocks. Pricing, the ratio test and the pivot updates run over ranges of
+ * columns or rows. A Plan says how many blocks a step is split into, 1 runs
+ * it in place. With SIMPLEX_THREADS every block but the first is spawned on
+ * the work-stealing pool and the caller runs the first itself. Each block
+ * keeps its own best candidate and the caller merges them in index order,
+ * so there is nothing shared to lock.
+ *
+ * The blocks live on the caller's stack and carry no atomics of their own.
+ * split writes them before ws_spawn, whose push publishes the task with a
+ * release fence that the acquire side of the Chase-Lev steal pairs with.
+ * The results go back through the release store of done in the runtime,
+ * read by ws_sync with an acquire load before the merge. Thread sanitizer
+ * does not model those fences and reports the split writes as races.
+ */
+
+typedef struct Plan{
+    int blocks;     // Blocks per step, at most MAX_BLOCKS
+    int segments;   // Partial pricing segments, 1 prices every column
+    int segment;    // Segment priced next
+}Plan;
+
+static const Plan SERIAL = {1, 1, 0};
+
+typedef struct Block Block;
+struct Block{
+#ifdef SIMPLEX_THREADS
+    Task task;
+#endif
+    void (*body)(Block *b);
+    Tableu *t;
+    int begin;      // Columns or rows [begin, end)
+    int end;
+    int r;          // Pivot row
+    int q;          // Entering column
+    Pricing rule;
+    double scale;   // Devex weight of q
+    double limit;   // Largest ratio that ties in the ratio test
+    int best;       // Result, -1 if the block has no candidate
+    double value;
+};
+
+#ifdef SIMPLEX_THREADS
+static void block_task(Task *task){
+    Block *b = (Block *)task;
+    b->body(b);
+}
+#endif
+
+// Copies job into blocks of [begin, end), at least grain long and starting
+// on a cache line. The number of blocks, 0 for an empty range.
+static int split(Block *blocks, const Plan *plan, const Block *job, int begin, int end, int grain){
+    int size = (end - begin + plan->blocks - 1) / plan->blocks;
+    if (size < grain)
+        size = grain;
+    size = (size + 7) & ~7;
+    int n = 0;
+    for (int k = begin; k < end; k += size){
+        blocks[n] = *job;
+        blocks[n].begin = k;
+        blocks[n].end = end - k > size ? k + size : end;
+        blocks[n].best = -1;
+        blocks[n].value = 0.0;
+        n++;
+    }
+    return n;
+}
+
+static void run_blocks(Block *blocks, int n){
+#ifdef SIMPLEX_THREADS
+    if (n > 1){
+        for (int k = 1; k < n; k++){
+            blocks[k].task.run = block_task;
+            ws_spawn(&blocks[k].task);
+        }
+        blocks[0].body(&blocks[0]);
+        for (int k = n - 1; k > 0; k--)
+            ws_sync(&blocks[k].task);
+        return;
+    }
+#endif
+    for (int k = 0; k < n; k++)
+        blocks[k].body(&blocks[k]);
+}
+
+// Eliminates column q from the rows of the block with the scaled pivot row
+static void pivot_block(Block *b){
+    Tableu *t = b->t;
+    const size_t n = t->stride;
+    const double *pr = tableu_row(t, b->r);
+    for (int i = b->begin; i < b->end; i++){
+        double *row = tableu_row(t, i);
+        double a = row[b->q];
+        if (i == b->r || a == 0.0)
+            continue;
+        row_axpy(row, pr, -a, n);
+        row[b->q] = 0.0;
+    }
+}
+
+// Pivots variable q into the basis at row r
+static void pivot(Tableu *t, int r, int q, const Plan *plan){
+    const size_t n = t->stride;
+    double *pr = tableu_row(t, r);
+    row_scale(pr, 1.0 / pr[q], n);
+    pr[q] = 1.0;
+    Block blocks[MAX_BLOCKS];
+    Block job = {.body = pivot_block, .t = t, .r = r, .q = q};
+    run_blocks(blocks, split(blocks, plan, &job, 0, t->rows, ROW_GRAIN));
+    double d = t->reduces_costs[q];
+    if (d != 0.0){
+        row_axpy(t->reduces_costs, pr, -d, n);
+        t->reduces_costs[q] = 0.0;
+    }
+
+    int leaving = t->basis_headers[r];
+    t->basis_headers[r] = q;
+    for (int k = 0; k < t->total - t->rows; k++){
+        if (t->non_basis_headers[k] == q){
+            t->non_basis_headers[k] = leaving;
+            break;
+        }
+    }
+    t->iterations++;
+}
+
+// Steepest edge norms 1 + |a_j|^2 of the columns of the block, summed a row
+// at a time so the tableau is read in order
+static void column_norms(Block *b){
+    const Tableu *t = b->t;
+    double *restrict w = t->weights;
+    for (int k = b->begin; k < b->end; k++)
+        w[k] = 1.0;
+    for (int i = 0; i < t->rows; i++){
+        const double *restrict row = tableu_row(t, i);
+        for (int k = b->begin; k < b->end; k++)
+            w[k] += row[k] * row[k];
+    }
+}
+
+/*
+ * Best entering column of the block: Bland the first with a negative reduced
+ * cost, Dantzig the most negative, steepest edge and devex the largest
+ * d_j^2 / w_j. Ties go to the lower column.
+ */
+static void price_block(Block *b){
+    if (b->rule == PRICING_STEEPEST_EDGE)
+        column_norms(b);
+    const double *d = b->t->reduces_costs;
+    const double *w = b->t->weights;
+    for (int j = b->begin; j < b->end; j++){
+        if (d[j] >= -SIMPLEX_EPSILON)
+            continue;
+        if (b->rule == PRICING_BLAND){
+            b->best = j;
+            return;
+        }
+        double score = b->rule == PRICING_DANTZIG ? -d[j] : d[j] * d[j] / w[j];
+        if (score > b->value){
+            b->best = j;
+            b->value = score;
+        }
+    }
+}
+
+// Best entering column in [begin, end), -1 if there is none
+static int price_range(Tableu *t, Pricing rule, const Plan *plan, int begin, int end){
+    Block blocks[MAX_BLOCKS];
+    Block job = {.body = price_block, .t = t, .rule = rule};
+    int n = split(blocks, plan, &job, begin, end, COLUMN_GRAIN);
+    run_blocks(blocks, n);
+    int best = -1;
+    double best_value = 0.0;
+    for (int k = 0; k < n; k++){
+        if (blocks[k].best < 0)
+            continue;
+        if (rule == PRICING_BLAND)
+            return blocks[k].best;
+        if (blocks[k].value > best_value){
+            best = blocks[k].best;
+            best_value = blocks[k].value;
+        }
+    }
+    return best;
+}
+
+/*
+ * Entering column with a negative reduced cost, -1 if the basis is optimal.
+ * Artificial columns never enter. Partial pricing looks at one segment of
+ * the columns per pivot, round robin, and only moves on within the same
+ * pivot while the segments have no candidate. Bland prices everything, it
+ * needs the lowest index.
+ */
+static int price(Tableu *t, Pricing rule, Plan *plan){
+    const int end = artificial_begin(t);
+    if (rule == PRICING_BLAND || plan->segments <= 1)
+        return price_range(t, rule, plan, 0, end);
+    int size = ((end + plan->segments - 1) / plan->segments + 7) & ~7;
+    int segments = (end + size - 1) / size;
+    for (int s = 0; s < segments; s++){
+        int k = (plan->segment + s) % segments;
+        int stop = end - k * size > size ? (k + 1) * size : end;
+        int q = price_range(t, rule, plan, k * size, stop);
+        if (q >= 0){
+            plan->segment = (k + 1) % segments;
+            return q;
+        }
+    }
+    return -1;
+}
+
+// Smallest ratio of the block, best is any row that has it
+static void ratio_min_block(Block *b){
+    const Tableu *t = b->t;
+    const int rhs = t->total;
+    for (int i = b->begin; i < b->end; i++){
+        const double *row = tableu_row(t, i);
+        if (row[b->q] <= SIMPLEX_EPSILON)
+            continue;
+        double r = row[rhs] / row[b->q];
+        if (b->best < 0 || r < b->value){
+            b->best = i;
+            b->value = r;
+        }
+    }
+}
+
+// Row of the block with the lowest basic variable among the ratios up to
+// limit, the tie break of Bland
+static void ratio_tie_block(Block *b){
+    const Tableu *t = b->t;
+    const int rhs = t->total;
+    for (int i = b->begin; i < b->end; i++){
+        const double *row = tableu_row(t, i);
+        if (row[b->q] <= SIMPLEX_EPSILON)
+            continue;
+        double r = row[rhs] / row[b->q];
+        if (r <= b->limit && (b->best < 0 || t->basis_headers[i] < t->basis_headers[b->best])){
+            b->best = i;
+            b->value = r;
+        }
+    }
+}
+
+/*
+ * Leaving row for entering column q, -1 if q is unbounded. Ratios within
+ * SIMPLEX_EPSILON of the smallest tie and go to the lowest basic variable.
+ * Two passes, the exact minimum and then the lowest basic variable up to
+ * it plus epsilon: both merge to the same row whatever the blocks, where
+ * comparing each new ratio to the best so far depends on the scan order.
+ */
+static int ratio_test(Tableu *t, int q, double *ratio, const Plan *plan){
+    Block blocks[MAX_BLOCKS];
+    Block job = {.body = ratio_min_block, .t = t, .q = q};
+    int n = split(blocks, plan, &job, 0, t->rows, ROW_GRAIN);
+    run_blocks(blocks, n);
+    int best = -1;
+    double min = 0;
+    for (int k = 0; k < n; k++){
+        if (blocks[k].best >= 0 && (best < 0 || blocks[k].value < min)){
+            best = blocks[k].best;
+            min = blocks[k].value;
+        }
+    }
+    if (best < 0)
+        return -1;
+
+    job.body = ratio_tie_block;
+    job.limit = min + SIMPLEX_EPSILON;
+    n = split(blocks, plan, &job, 0, t->rows, ROW_GRAIN);
+    run_blocks(blocks, n);
+    best = -1;
+    double best_ratio = 0;
+    for (int k = 0; k < n; k++){
+        if (blocks[k].best >= 0 &&
+            (best < 0 || t->basis_headers[blocks[k].best] < t->basis_headers[best])){
+            best = blocks[k].best;
+            best_ratio = blocks[k].value;
+        }
+    }
+    *ratio = best_ratio;
+    return best;
+}
+
+// Devex reference weights after a pivot on column q with weight scale:
+// w_j = max(w_j, (a_rj / a_rq)^2 w_q), read off the scaled pivot row
+static void devex_block(Block *b){
+    double *restrict w = b->t->weights;
+    const double *restrict pr = tableu_row(b->t, b->r);
+    for (int j = b->begin; j < b->end; j++)
+        w[j] = fmax(w[j], pr[j] * pr[j] * b->scale);
+}
+
+// Sets the objective row to the reduced costs of costs (one per column)
+// under the current basis
+static void price_out(Tableu *t, const double *costs){
+    double *d = t->reduces_costs;
+    for (size_t k = 0; k < t->stride; k++)
+        d[k] = 0.0;
+    for (int j = 0; j < t->total; j++)
+        d[j] = costs[j];
+    for (int i = 0; i < t->rows; i++){
+        double c = costs[t->basis_headers[i]];
+        if (c != 0.0)
+            row_axpy(d, tableu_row(t, i), -c, t->stride);
+    }
+}
+
+// Pivots until optimal, unbounded or out of iterations
+static SimplexStatus iterate(Tableu *t, Pricing pricing, int max_iterations, Plan *plan){
+    // Devex starts every weight at 1, the reference framework is the
+    // nonbasic set of this call
+    if (pricing == PRICING_DEVEX)
+        for (size_t k = 0; k < t->stride; k++)
+            t->weights[k] = 1.0;
+    int degenerate = 0;
+    while (t->iterations < max_iterations){
+        Pricing rule = pricing;
+        if (degenerate >= DEGENERATE_RUN)
+            rule = PRICING_BLAND;
+        int q = price(t, rule, plan);
+        if (q < 0)
+            return SIMPLEX_OPTIMAL;
+        double ratio;
+        int r = ratio_test(t, q, &ratio, plan);
+        if (r < 0)
+            return SIMPLEX_UNBOUNDED;
+        degenerate = ratio <= SIMPLEX_EPSILON ? degenerate + 1 : 0;
+        if (pricing != PRICING_DEVEX){
+            pivot(t, r, q, plan);
+            continue;
+        }
+        double a = tableu_row(t, r)[q];
+        double wq = t->weights[q];
+        int leaving = t->basis_headers[r];
+        pivot(t, r, q, plan);
+        Block blocks[MAX_BLOCKS];
+        Block job = {.body = devex_block, .t = t, .r = r, .scale = wq};
+        run_blocks(blocks, split(blocks, plan, &job, 0, artificial_begin(t), COLUMN_GRAIN));
+        t->weights[leaving] = fmax(wq / (a * a), 1.0);
+    }
+    return SIMPLEX_ITERATION_LIMIT;
+}
+
+// Writes slacks, artificials and the rhs, with every row scaled to b >= 0.
+// Rows whose slack can not start basic start with their artificial.
+static void prepare(Tableu *t){
+    const int rhs = t->total;
+    const int art = artificial_begin(t);
+    int slack = t->columns;
+    for (int i = 0; i < t->rows; i++){
+        double *row = tableu_row(t, i);
+        int slack_column = -1;
+        if (t->row_types[i] != ROW_EQ){
+            slack_column = slack++;
+            row[slack_column] = t->row_types[i] == ROW_LE ? 1.0 : -1.0;
+        }
+        row[rhs] = t->b_vector[i];
+        t->row_signs[i] = 1.0;
+        if (row[rhs] < 0){
+            row_scale(row, -1.0, t->stride);
+            t->row_signs[i] = -1.0;
+        }
+        row[art + i] = 1.0;
+        t->basis_headers[i] = slack_column >= 0 && row[slack_column] > 0 ? slack_column : art + i;
+    }
+    // Non-basic: every other column, artificials included. Basic slacks and
+    // artificials are marked in the scratch row for the lookup.
+    double *basic = t->weights;
+    for (size_t j = 0; j < t->stride; j++)
+        basic[j] = 0.0;
+    for (int i = 0; i < t->rows; i++)
+        basic[t->basis_headers[i]] = 1.0;
+    int k = 0;
+    for (int j = 0; j < t->total; j++)
+        if (basic[j] == 0.0)
+            t->non_basis_headers[k++] = j;
+}
+
+// Pivots artificials that are still basic at zero out of the basis. A row
+// without any other nonzero is redundant and keeps its artificial.
+static void drive_out_artificials(Tableu *t, const Plan *plan){
+    const int art = artificial_begin(t);
+    for (int i = 0; i < t->rows; i++){
+        if (t->basis_headers[i] < art)
+            continue;
+        const double *row = tableu_row(t, i);
+        for (int j = 0; j < art; j++){
+            if (fabs(row[j]) > SIMPLEX_EPSILON){
+                pivot(t, i, j, plan);
+                break;
+            }
+        }
+    }
+}
+
+static SimplexStatus solve(Tableu *t, const SimplexOptions *options, Plan *plan){
+    int max_iterations = options->max_iterations;
+    if (max_iterations <= 0)
+        max_iterations = 50 * (t->rows + t->total);
+    t->iterations = 0;
+    t->phase1_iterations = 0;
+    t->solved = 1;
+    prepare(t);
+
+    const int art = artificial_begin(t);
+    double *costs = calloc((size_t)t->total, sizeof(double));
+    if (!costs)
+        return SIMPLEX_OUT_OF_MEMORY;
+
+    // Phase I: minimize the sum of the artificials that start basic
+    int artificials = 0;
+    for (int i = 0; i < t->rows; i++){
+        if (t->basis_headers[i] >= art){
+            costs[t->basis_headers[i]] = 1.0;
+            artificials++;
+        }
+    }
+    SimplexStatus status = SIMPLEX_OPTIMAL;
+    if (artificials){
+        price_out(t, costs);
+        status = iterate(t, options->pricing, max_iterations, plan);
+        t->phase1_iterations = t->iterations;
+        double infeasibility = -t->reduces_costs[t->total];
+        if (status == SIMPLEX_OPTIMAL && infeasibility > SIMPLEX_EPSILON * t->rows)
+            status = SIMPLEX_INFEASIBLE;
+        if (status == SIMPLEX_OPTIMAL)
+            drive_out_artificials(t, plan);
+    }
+
+    // Phase II: the real costs
+    if (status == SIMPLEX_OPTIMAL){
+        for (int j = 0; j < t->total; j++)
+            costs[j] = j < t->columns ? t->z_vector[j] : 0.0;
+        price_out(t, costs);
+        status = iterate(t, options->pricing, max_iterations, plan);
+    }
+    free(costs);
+    return status;
+}
+
+typedef SimplexStatus (*Solver)(Tableu *t, const SimplexOptions *options, Plan *plan);
+
+#ifdef SIMPLEX_THREADS
+// A whole solve as the root task, so the workers stay awake between pivots
+typedef struct SolveTask{
+    Task task;
+    Solver solver;
+    Tableu *t;
+    const SimplexOptions *options;
+    Plan *plan;
+    SimplexStatus status;
+}SolveTask;
+
+static void solve_task(Task *task){
+    SolveTask *s = (SolveTask *)task;
+    s->status = s->solver(s->t, s->options, s->plan);
+}
+#endif
+
+// Runs solver with the blocks and partial pricing of options
+static SimplexStatus run_plan(Tableu *t, const SimplexOptions *options, Solver solver){
+    Plan plan = SERIAL;
+    if (options->partial_pricing > 1)
+        plan.segments = options->partial_pricing;
+#ifdef SIMPLEX_THREADS
+    int workers = ws_workers();
+    if (options->parallel && workers > 1 && (double)t->rows * t->stride >= PARALLEL_MIN_WORK){
+        plan.blocks = 2 * workers < MAX_BLOCKS ? 2 * workers : MAX_BLOCKS;
+        SolveTask root = {{solve_task, 0}, solver, t, options, &plan, SIMPLEX_OPTIMAL};
+        ws_run(&root.task);
+        return root.status;
+    }
+#endif
+    return solver(t, options, &plan);
+}
+
+SimplexStatus simplex_solve(Tableu *t, const SimplexOptions *options){
+    return run_plan(t, options ? options : &SIMPLEX_DEFAULTS, solve);
+}
+
+/*
+ * Warm start. After a solve the artificial block of the tableau holds B^-1
+ * of the row scaled problem, so a new b only needs the rhs column
+ * recomputed, B^-1 S b, and new costs only the objective row. Both keep the
+ * basis. What they break is fixed from there: negative rhs by the dual
+ * simplex, negative reduced costs by the primal.
+ */
+
+// rhs = B^-1 S b from the artificial block
+static void recompute_rhs(Tableu *t){
+    const int rhs = t->total;
+    const int art = artificial_begin(t);
+    for (int i = 0; i < t->rows; i++){
+        double *row = tableu_row(t, i);
+        double v = 0.0;
+        for (int k = 0; k < t->rows; k++)
+            v += row[art + k] * t->row_signs[k] * t->b_vector[k];
+        row[rhs] = v;
+    }
+}
+
+// Most infeasible row, -1 if the basis is primal feasible
+static int dual_leaving(const Tableu *t){
+    const int rhs = t->total;
+    int best = -1;
+    double best_v = -SIMPLEX_EPSILON;
+    for (int i = 0; i < t->rows; i++){
+        double v = tableu_row(t, i)[rhs];
+        if (v < best_v){
+            best = i;
+            best_v = v;
+        }
+    }
+    return best;
+}
+
+// Entering column for leaving row r: the smallest d_j / -a_rj over a_rj < 0,
+// which keeps every reduced cost >= 0. Ties go to the larger |a_rj|, then
+// the lowest column. -1 if row r can not be fixed, the problem is infeasible.
+static int dual_ratio_test(const Tableu *t, int r){
+    const double *row = tableu_row(t, r);
+    const double *d = t->reduces_costs;
+    const int end = artificial_begin(t);
+    int best = -1;
+    double best_ratio = 0.0;
+    for (int j = 0; j < end; j++){
+        if (row[j] >= -SIMPLEX_EPSILON)
+            continue;
+        double ratio = fmax(d[j], 0.0) / -row[j];
+        if (best < 0 || ratio < best_ratio - SIMPLEX_EPSILON ||
+            (ratio <= best_ratio + SIMPLEX_EPSILON && row[j] < row[best] - SIMPLEX_EPSILON)){
+            best = j;
+            best_ratio = ratio;
+        }
+    }
+    return best;
+}
+
+// Dual simplex pivots until primal feasible, from a dual feasible basis
+static SimplexStatus dual_iterate(Tableu *t, int max_iterations, const Plan *plan){
+    while (t->iterations < max_iterations){
+        int r = dual_leaving(t);
+        if (r < 0)
+            return SIMPLEX_OPTIMAL;
+        int q = dual_ratio_test(t, r);
+        if (q < 0)
+            return SIMPLEX_INFEASIBLE;
+        pivot(t, r, q, plan);
+    }
+    return SIMPLEX_ITERATION_LIMIT;
+}
+
+static int dual_feasible(const Tableu *t){
+    const int end = artificial_begin(t);
+    for (int j = 0; j < end; j++)
+        if (t->reduces_costs[j] < -SIMPLEX_EPSILON)
+            return 0;
+    return 1;
+}
+
+static SimplexStatus resolve(Tableu *t, const SimplexOptions *options, Plan *plan){
+    if (!t->solved)
+        return solve(t, options, plan);
+    int max_iterations = options->max_iterations;
+    if (max_iterations <= 0)
+        max_iterations = 50 * (t->rows + t->total);
+    t->iterations = 0;
+    t->phase1_iterations = 0;
+    // Artificials a failed phase I left basic go first, where they can
+    drive_out_artificials(t, plan);
+    recompute_rhs(t);
+
+    // An artificial still basic sits on a row with no other entries left,
+    // the rhs of that row has to stay 0
+    const int art = artificial_begin(t);
+    for (int i = 0; i < t->rows; i++)
+        if (t->basis_headers[i] >= art && fabs(tableu_row(t, i)[t->total]) > SIMPLEX_EPSILON)
+            return SIMPLEX_INFEASIBLE;
+
+    double *costs = calloc((size_t)t->total, sizeof(double));
+    if (!costs)
+        return SIMPLEX_OUT_OF_MEMORY;
+    SimplexStatus status = SIMPLEX_OPTIMAL;
+    if (dual_leaving(t) >= 0){
+        for (int j = 0; j < t->columns; j++)
+            costs[j] = t->z_vector[j];
+        price_out(t, costs);
+        // New costs broke dual feasibility too: the dual simplex runs on
+        // zero costs, for which any basis is dual feasible
+        if (!dual_feasible(t)){
+            for (int j = 0; j < t->columns; j++)
+                costs[j] = 0.0;
+            price_out(t, costs);
+        }
+        status = dual_iterate(t, max_iterations, plan);
+        t->phase1_iterations = t->iterations;
+    }
+    if (status == SIMPLEX_OPTIMAL){
+        for (int j = 0; j < t->columns; j++)
+            costs[j] = t->z_vector[j];
+        price_out(t, costs);
+        status = iterate(t, options->pricing, max_iterations, plan);
+    }
+    free(costs);
+    return status;
+}
+
+SimplexStatus simplex_resolve(Tableu *t, const SimplexOptions *options){
+    return run_plan(t, options ? options : &SIMPLEX_DEFAULTS, resolve);
+}
+
+void simplex_basis(const Tableu *t, int *basis){
+    for (int i = 0; i < t->rows; i++)
+        basis[i] = t->basis_headers[i];
+}
+
+int simplex_set_basis(Tableu *t, const int *basis){
+    if (t->solved)
+        return -1;
+    t->iterations = 0;
+    prepare(t);
+    t->solved = 1;
+    // Rows already holding a variable of the new basis
+    int *taken = calloc((size_t)t->rows, sizeof(int));
+    double *wanted = t->weights;
+    if (!taken)
+        return -1;
+    for (size_t j = 0; j < t->stride; j++)
+        wanted[j] = 0.0;
+    for (int i = 0; i < t->rows; i++)
+        if (basis[i] >= 0 && basis[i] < t->total)
+            wanted[basis[i]] = 1.0;
+    for (int i = 0; i < t->rows; i++)
+        taken[i] = wanted[t->basis_headers[i]] != 0.0;
+    // Gauss-Jordan: each variable into the free row with its largest entry
+    int missing = 0;
+    for (int k = 0; k < t->rows; k++){
+        int v = basis[k];
+        if (v < 0 || v >= t->total || wanted[v] == 0.0)
+            continue;
+        wanted[v] = 0.0;
+        int r = -1;
+        for (int i = 0; i < t->rows; i++){
+            if (t->basis_headers[i] == v){
+                r = -2;
+                break;
+            }
+            double a = fabs(tableu_row(t, i)[v]);
+            if (!taken[i] && a > SIMPLEX_EPSILON && (r < 0 || a > fabs(tableu_row(t, r)[v])))
+                r = i;
+        }
+        if (r == -2)
+            continue;
+        if (r < 0){
+            missing++;
+            continue;
+        }
+        pivot(t, r, v, &SERIAL);
+        taken[r] = 1;
+    }
+    free(taken);
+    // Rows left with their artificial take any other column they can
+    drive_out_artificials(t, &SERIAL);
+    // The imported pivots are setup, not iterations of a solve
+    t->iterations = 0;
+    double *costs = calloc((size_t)t->total, sizeof(double));
+    if (!costs)
+        return -1;
+    for (int j = 0; j < t->columns; j++)
+        costs[j] = t->z_vector[j];
+    price_out(t, costs);
+    free(costs);
+    return missing;
+}
+
+double simplex_objective(const Tableu *t){
+    return -t->reduces_costs[t->total];
+}
+
+void simplex_solution(const Tableu *t, double *x){
+    for (int j = 0; j < t->columns; j++)
+        x[j] = 0.0;
+    for (int i = 0; i < t->rows; i++){
+        int j = t->basis_headers[i];
+        if (j < t->columns)
+            x[j] = tableu_row(t, i)[t->total];
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef SIMPLEX_H
+#define SIMPLEX_H
+
+#include <stddef.h>
+
+typedef enum RowType{
+    ROW_LE, // a x <= b
+    ROW_GE, // a x >= b
+    ROW_EQ  // a x == b
+}RowType;
+
+typedef enum Pricing{
+    PRICING_DANTZIG,       // Most negative reduced cost, Bland after degenerate runs
+    PRICING_BLAND,         // Lowest index with a negative reduced cost, never cycles
+    PRICING_STEEPEST_EDGE, // Largest decrease per unit of edge length, fewest pivots
+    PRICING_DEVEX          // Steepest edge with reference weights updated per pivot
+}Pricing;
+
+typedef enum SimplexStatus{
+    SIMPLEX_OPTIMAL,
+    SIMPLEX_INFEASIBLE,
+    SIMPLEX_UNBOUNDED,
+    SIMPLEX_ITERATION_LIMIT,
+    SIMPLEX_OVERFLOW,           // Exact arithmetic only
+    SIMPLEX_SINGULAR,           // Sparse LU only
+    SIMPLEX_OUT_OF_MEMORY       // A work array could not be allocated
+}SimplexStatus;
+
+typedef struct SimplexOptions{
+    Pricing pricing;
+    int max_iterations;  // 0 picks a limit from the size of the problem
+    int partial_pricing; // Column segments priced one at a time, 0 or 1 prices all
+    int parallel;        // Split pricing, ratio test and pivots over the ws_init workers
+}SimplexOptions;
+
+extern const SimplexOptions SIMPLEX_DEFAULTS;
+
+/*
+ * Dense simplex tableau for
+ *
+ *   minimize z^T x  subject to  A x (<=, >=, ==) b,  x >= 0
+ *
+ * Everything lives in one 64 byte aligned allocation. a_matrix holds the
+ * tableau rows [A | slacks | artificials | rhs] row-major, stride doubles per
+ * row, padded so that every row starts on a cache line and a pivot is a
+ * plain axpy over whole rows. Column `total` is the right hand side.
+ *
+ * The columns are the n structural variables, one slack per inequality row
+ * and one artificial per row. The artificial block starts out as the identity
+ * and is kept up to date by every pivot, so it always holds the inverse of
+ * the basis (up to the row signs). The basis is bookkept as index arrays:
+ * basis_headers[i] is the variable basic in row i, non_basis_headers the
+ * others.
+ */
+typedef struct Tableu{
+    int rows;                   // m
+    int columns;                // n structural variables
+    int slacks;                 // Inequality rows
+    int total;                  // columns + slacks + rows
+    size_t stride;              // Doubles per tableau row
+    RowType *row_types;
+    double *z_vector;           // c-Transpose, n costs
+    double *a_matrix;           // A, then the working tableau, rows x stride
+    double *b_vector;           // b
+    double *row_signs;          // -1 for rows negated to make b >= 0
+    int *basis_headers;         // c_B-T, basic variable of each row
+    int *non_basis_headers;     // c_N-T, total - rows variables
+    double *reduces_costs;      // Objective row, stride doubles, rhs is -z
+    double *weights;            // Scratch row, stride doubles
+    int iterations;             // Pivots of the last solve, both phases
+    int phase1_iterations;
+    int solved;
+    void *storage;
+}Tableu;
+
+/* tableu_create(rows, columns, row_types) -> tableu
+ * Allocates a zeroed tableau for rows constraints of the given types over
+ * columns variables. Fill it with tableu_set_a/b/z. NULL if out of memory.
+ */
+Tableu *tableu_create(int rows, int columns, const RowType *row_types);
+void tableu_destroy(Tableu *t);
+
+// Row i of the working tableau, aligned to 64 bytes
+static inline double *tableu_row(const Tableu *t, int i){
+    return t->a_matrix + (size_t)i * t->stride;
+}
+static inline void tableu_set_a(Tableu *t, int i, int j, double v){
+    tableu_row(t, i)[j] = v;
+}
+static inline void tableu_set_b(Tableu *t, int i, double v){
+    t->b_vector[i] = v;
+}
+static inline void tableu_set_z(Tableu *t, int j, double v){
+    t->z_vector[j] = v;
+}
+
+/* simplex_solve(t, options) -> status
+ * Two phase primal simplex on the tableau, once per tableau. options may be
+ * NULL for SIMPLEX_DEFAULTS. SIMPLEX_OUT_OF_MEMORY if its work arrays can
+ * not be allocated.
+ *
+ * Built with SIMPLEX_THREADS (and ../fib/workstealing.c, -pthread) and
+ * options->parallel set, a large tableau is solved inside one ws_run of the
+ * work-stealing pool: pricing and the column norms are split into column
+ * blocks, the ratio test and the pivot updates into row blocks, and every
+ * block reports its best candidate, merged in index order under the serial
+ * tie rules. The merges do not depend on how the work is split, so a solve
+ * takes the same pivots on any number of workers. Call ws_init first, and
+ * not from inside a task.
+ */
+SimplexStatus simplex_solve(Tableu *t, const SimplexOptions *options);
+
+/*
+ * Warm start. A solved tableau keeps its basis and B^-1, so after changing
+ * b or z with tableu_set_b/z, simplex_resolve re-optimizes from the last
+ * basis instead of starting over: the dual simplex while some basic value is
+ * negative (new b), then the primal for the costs (new z). A handful of
+ * pivots for small changes. Variable bounds are rows of A here, so a bound
+ * change is a tableu_set_b on its row. A is not kept, new entries of A need a
+ * fresh tableau, which can start from the old basis with simplex_set_basis.
+ */
+
+/* simplex_resolve(t, options) -> status
+ * Re-optimizes after tableu_set_b/z, simplex_solve if t was never solved.
+ * iterations counts the pivots of this call, phase1_iterations the dual ones.
+ */
+SimplexStatus simplex_resolve(Tableu *t, const SimplexOptions *options);
+// The basic variable of each row, rows entries
+void simplex_basis(const Tableu *t, int *basis);
+/* simplex_set_basis(t, basis) -> missing
+ * Pivots the variables of basis (rows entries, from simplex_basis) into a
+ * filled tableau that was not solved yet, then simplex_resolve finishes from
+ * there. Variables that would make the basis singular are left out, their
+ * rows keep a slack or artificial. The number left out, -1 if t was already
+ * solved or out of memory.
+ */
+int simplex_set_basis(Tableu *t, const int *basis);
+
+// z^T x of the current basis
+double simplex_objective(const Tableu *t);
+// Values of the n structural variables of the current basis
+void simplex_solution(const Tableu *t, double *x);
+
+#endif
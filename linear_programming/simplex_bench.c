@@ -0,0 +1,244 @@
+// cc -O2 simplex_bench.c simplex.c simplex_data.c -lm -o simplex_bench
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#include "simplex.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Solves a few standard LPs with every pricing rule and prints the pivots,
+ * the time and the pivots per second:
+ *
+ *   wyndor          the textbook 2 variable product mix, optimum -36
+ *   klee_minty_n    the Klee-Minty cube, 2^n - 1 pivots under Dantzig
+ *   transport_n     an n x n transportation problem, equality rows (phase I)
+ *   dense_n         a random dense n x n LP with <= rows
+ *
+ * then re-solves transport and dense after small changes to b or z, warm
+ * from the previous basis, against a cold solve of the same data.
+ */
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static Tableu *make(int rows, int columns, RowType type){
+    RowType *types = malloc(rows * sizeof(RowType));
+    if (!types){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < rows; i++)
+        types[i] = type;
+    Tableu *t = tableu_create(rows, columns, types);
+    free(types);
+    if (!t){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    return t;
+}
+
+// max 3x + 5y  s.t.  x <= 4, 2y <= 12, 3x + 2y <= 18
+static Tableu *wyndor(int n){
+    (void)n;
+    Tableu *t = make(3, 2, ROW_LE);
+    tableu_set_a(t, 0, 0, 1);
+    tableu_set_a(t, 1, 1, 2);
+    tableu_set_a(t, 2, 0, 3);
+    tableu_set_a(t, 2, 1, 2);
+    tableu_set_b(t, 0, 4);
+    tableu_set_b(t, 1, 12);
+    tableu_set_b(t, 2, 18);
+    tableu_set_z(t, 0, -3);
+    tableu_set_z(t, 1, -5);
+    return t;
+}
+
+// max sum 2^(n-j) x_j  s.t.  2 sum_{j<i} 2^(i-j) x_j + x_i <= 5^i
+static Tableu *klee_minty(int n){
+    Tableu *t = make(n, n, ROW_LE);
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < i; j++)
+            tableu_set_a(t, i, j, ldexp(1.0, i - j + 1));
+        tableu_set_a(t, i, i, 1);
+        tableu_set_b(t, i, pow(5.0, i + 1));
+        tableu_set_z(t, i, -ldexp(1.0, n - i - 1));
+    }
+    return t;
+}
+
+static uint32_t lcg(uint32_t *x){
+    *x = *x * 1664525u + 1013904223u;
+    return *x >> 8;
+}
+
+// n suppliers, n customers, balanced supply and demand, x_ij shipped
+static Tableu *transport(int n){
+    Tableu *t = make(2 * n, n * n, ROW_EQ);
+    uint32_t x = 7;
+    double total = 0;
+    for (int i = 0; i < n; i++){
+        double supply = 10 + lcg(&x) % 90;
+        tableu_set_b(t, i, supply);
+        total += supply;
+    }
+    // Demands sum to the supply
+    double left = total;
+    for (int j = 0; j < n; j++){
+        double demand = j == n - 1 ? left : floor(total / n);
+        tableu_set_b(t, n + j, demand);
+        left -= demand;
+    }
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            tableu_set_a(t, i, i * n + j, 1);
+            tableu_set_a(t, n + j, i * n + j, 1);
+            tableu_set_z(t, i * n + j, 1 + lcg(&x) % 20);
+        }
+    }
+    return t;
+}
+
+// max c x  s.t.  A x <= b, positive A, b and c
+static Tableu *dense(int n){
+    Tableu *t = make(n, n, ROW_LE);
+    uint32_t x = 12345;
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++)
+            tableu_set_a(t, i, j, 1 + lcg(&x) % 100);
+        tableu_set_b(t, i, 1000 + lcg(&x) % 1000);
+    }
+    for (int j = 0; j < n; j++)
+        tableu_set_z(t, j, -(1.0 + lcg(&x) % 50));
+    return t;
+}
+
+static const char *STATUS_NAMES[] = {"optimal", "infeasible", "unbounded", "limit", "overflow",
+                                     "singular", "memory"};
+static const char *PRICING_NAMES[] = {"dantzig", "bland", "steepest", "devex"};
+
+static void run(const char *name, Tableu *(*build)(int), int n){
+    for (int p = PRICING_DANTZIG; p <= PRICING_DEVEX; p++){
+        SimplexOptions options = SIMPLEX_DEFAULTS;
+        options.pricing = (Pricing)p;
+        options.max_iterations = 1 << 20; // Klee-Minty runs past the default
+        Tableu *t = build(n);
+        double start = now_seconds();
+        SimplexStatus status = simplex_solve(t, &options);
+        double seconds = now_seconds() - start;
+        printf("%-16s %-9s %5d x %-5d %-10s %16.6f %7d %10.3f ms %12.0f pivots/s\n",
+               name, PRICING_NAMES[p], t->rows, t->columns, STATUS_NAMES[status],
+               simplex_objective(t), t->iterations, seconds * 1e3,
+               t->iterations / seconds);
+        tableu_destroy(t);
+    }
+}
+
+// Problem n with its b and z replaced
+static Tableu *changed(Tableu *(*build)(int), int n, const double *b, const double *z){
+    Tableu *t = build(n);
+    for (int i = 0; i < t->rows; i++)
+        tableu_set_b(t, i, b[i]);
+    for (int j = 0; j < t->columns; j++)
+        tableu_set_z(t, j, z[j]);
+    return t;
+}
+
+/*
+ * Solves problem n, then `rounds` times changes b (even rounds) or z (odd
+ * rounds) by up to +-5% and re-optimizes from the last basis. Each re-solve
+ * is checked against a cold solve of the same data. The last line imports
+ * the final basis into a fresh tableau with simplex_set_basis.
+ */
+static void run_warm(const char *name, Tableu *(*build)(int), int n, int rounds){
+    Tableu *t = build(n);
+    simplex_solve(t, NULL);
+    double *b = malloc(t->rows * sizeof(double));
+    double *z = malloc(t->columns * sizeof(double));
+    int *basis = malloc(t->rows * sizeof(int));
+    if (!b || !z || !basis){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < t->rows; i++)
+        b[i] = t->b_vector[i];
+    for (int j = 0; j < t->columns; j++)
+        z[j] = t->z_vector[j];
+    uint32_t x = 2024;
+    double warm_seconds = 0, cold_seconds = 0;
+    long warm_pivots = 0, cold_pivots = 0;
+    for (int round = 0; round < rounds; round++){
+        // Transportation rows must stay balanced, so its b moves as a whole
+        double scale = 1.0 + ((double)(lcg(&x) % 1001) - 500.0) / 10000.0;
+        if (round % 2 == 0)
+            for (int i = 0; i < t->rows; i++)
+                b[i] *= build == transport ? scale
+                                           : 1.0 + ((double)(lcg(&x) % 1001) - 500.0) / 10000.0;
+        else
+            for (int j = 0; j < t->columns; j++)
+                z[j] *= 1.0 + ((double)(lcg(&x) % 1001) - 500.0) / 10000.0;
+        for (int i = 0; i < t->rows; i++)
+            tableu_set_b(t, i, b[i]);
+        for (int j = 0; j < t->columns; j++)
+            tableu_set_z(t, j, z[j]);
+        double start = now_seconds();
+        SimplexStatus warm = simplex_resolve(t, NULL);
+        warm_seconds += now_seconds() - start;
+        warm_pivots += t->iterations;
+
+        Tableu *c = changed(build, n, b, z);
+        start = now_seconds();
+        SimplexStatus cold = simplex_solve(c, NULL);
+        cold_seconds += now_seconds() - start;
+        cold_pivots += c->iterations;
+        double difference = fabs(simplex_objective(t) - simplex_objective(c));
+        if (warm != cold || difference > 1e-6 * (1 + fabs(simplex_objective(c)))){
+            fprintf(stderr, "Error: %s round %d: warm %s %f, cold %s %f\n", name, round,
+                    STATUS_NAMES[warm], simplex_objective(t), STATUS_NAMES[cold],
+                    simplex_objective(c));
+            exit(EXIT_FAILURE);
+        }
+        tableu_destroy(c);
+    }
+    printf("%-16s %5d x %-5d %3d re-solves  warm %6.1f pivots %9.3f ms  "
+           "cold %7.1f pivots %9.3f ms\n", name, t->rows, t->columns, rounds,
+           (double)warm_pivots / rounds, warm_seconds * 1e3 / rounds,
+           (double)cold_pivots / rounds, cold_seconds * 1e3 / rounds);
+
+    // The final basis into a fresh tableau of the same data
+    simplex_basis(t, basis);
+    Tableu *c = changed(build, n, b, z);
+    double start = now_seconds();
+    int missing = simplex_set_basis(c, basis);
+    SimplexStatus status = simplex_resolve(c, NULL);
+    double seconds = now_seconds() - start;
+    printf("%-16s %5s   %-5s import %d missing  %-10s %6d pivots %9.3f ms\n", "", "", "",
+           missing, STATUS_NAMES[status], c->iterations, seconds * 1e3);
+    tableu_destroy(c);
+    tableu_destroy(t);
+    free(b);
+    free(z);
+    free(basis);
+}
+
+int main(void){
+    printf("%-16s %-9s %-13s %-10s %16s %7s %13s\n", "problem", "pricing",
+           "rows x cols", "status", "objective", "pivots", "time");
+    run("wyndor", wyndor, 0);
+    run("klee_minty_10", klee_minty, 10);
+    run("klee_minty_15", klee_minty, 15);
+    run("transport_10", transport, 10);
+    run("transport_30", transport, 30);
+    run("dense_100", dense, 100);
+    run("dense_300", dense, 300);
+    printf("\n");
+    run_warm("transport_30", transport, 30, 20);
+    run_warm("dense_100", dense, 100, 20);
+    run_warm("dense_300", dense, 300, 10);
+    return 0;
+}
@@ -1,12 +1,73 @@
-typedef struct Tableu{
-    void* z_vector;             // c-Transpose
-    void* a_matrix;             // A
-    void* b_vector;             // b
-    void* basis_headers;        // c_B-T
-    void* non_basis_headers;    // c_N-T
-    void* basis_matrix;         // A_B
-    void* non_basis_matrix;     // A_N
-
-    void* reduces_costs;
-
-}Tableu;
\ No newline at end of file
+#include "simplex.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TABLEU_ALIGN 64
+
+// Bytes rounded up so the next block starts on a cache line
+static size_t aligned_size(size_t bytes){
+    return (bytes + TABLEU_ALIGN - 1) & ~(size_t)(TABLEU_ALIGN - 1);
+}
+
+Tableu *tableu_create(int rows, int columns, const RowType *row_types){
+    if (rows <= 0 || columns <= 0)
+        return NULL;
+    int slacks = 0;
+    for (int i = 0; i < rows; i++)
+        slacks += row_types[i] != ROW_EQ;
+    int total = columns + slacks + rows;
+    // Whole cache lines per row, with room for the rhs column
+    size_t stride = ((size_t)total + 1 + 7) & ~(size_t)7;
+
+    size_t a_bytes = aligned_size((size_t)rows * stride * sizeof(double));
+    size_t rc_bytes = aligned_size(stride * sizeof(double));
+    size_t z_bytes = aligned_size((size_t)columns * sizeof(double));
+    size_t b_bytes = aligned_size((size_t)rows * sizeof(double));
+    size_t basis_bytes = aligned_size((size_t)rows * sizeof(int));
+    size_t non_basis_bytes = aligned_size((size_t)(total - rows) * sizeof(int));
+    size_t types_bytes = aligned_size((size_t)rows * sizeof(RowType));
+    size_t bytes = a_bytes + 2 * rc_bytes + z_bytes + 2 * b_bytes + basis_bytes +
+                   non_basis_bytes + types_bytes;
+
+    Tableu *t = calloc(1, sizeof(Tableu));
+    unsigned char *p = aligned_alloc(TABLEU_ALIGN, bytes);
+    if (!t || !p){
+        free(t);
+        free(p);
+        return NULL;
+    }
+    memset(p, 0, bytes);
+    t->storage = p;
+    t->rows = rows;
+    t->columns = columns;
+    t->slacks = slacks;
+    t->total = total;
+    t->stride = stride;
+    t->a_matrix = (double *)p;
+    p += a_bytes;
+    t->reduces_costs = (double *)p;
+    p += rc_bytes;
+    t->weights = (double *)p;
+    p += rc_bytes;
+    t->z_vector = (double *)p;
+    p += z_bytes;
+    t->b_vector = (double *)p;
+    p += b_bytes;
+    t->row_signs = (double *)p;
+    p += b_bytes;
+    t->basis_headers = (int *)p;
+    p += basis_bytes;
+    t->non_basis_headers = (int *)p;
+    p += non_basis_bytes;
+    t->row_types = (RowType *)p;
+    memcpy(t->row_types, row_types, (size_t)rows * sizeof(RowType));
+    return t;
+}
+
+void tableu_destroy(Tableu *t){
+    if (!t)
+        return;
+    free(t->storage);
+    free(t);
+}
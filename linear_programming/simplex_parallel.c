@@ -0,0 +1,201 @@
+// Parallel pricing, ratio test and pivots of the dense simplex, with a scaling benchmark.
+// Native: cc -O2 -pthread -DSIMPLEX_THREADS -I../fib simplex_parallel.c simplex.c
+//           simplex_data.c ../fib/workstealing.c -lm -o simplex_parallel
+// Node:   emcc -O3 -pthread -s PROXY_TO_PTHREAD -s PTHREAD_POOL_SIZE=8 -s ALLOW_MEMORY_GROWTH
+//           -DSIMPLEX_THREADS -I../fib simplex_parallel.c simplex.c simplex_data.c
+//           ../fib/workstealing.c -o simplex_parallel.js
+// Run:    simplex_parallel [rows] [max workers] [segments], node simplex_parallel.js ...
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#include "simplex.h"
+#include "workstealing.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Columns per row of the LP, wide problems are where pricing dominates
+#define WIDTH 10
+
+static double seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t lcg(uint32_t *x){
+    *x = *x * 1664525u + 1013904223u;
+    return *x >> 8;
+}
+
+// max c x  s.t.  A x <= b, positive A, b and c, WIDTH * rows columns
+static Tableu *wide(int rows){
+    const int columns = WIDTH * rows;
+    RowType *types = calloc(rows, sizeof(RowType)); // All ROW_LE
+    Tableu *t = types ? tableu_create(rows, columns, types) : NULL;
+    free(types);
+    if (!t){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t x = 4242;
+    for (int i = 0; i < rows; i++){
+        for (int j = 0; j < columns; j++)
+            tableu_set_a(t, i, j, 1 + lcg(&x) % 100);
+        tableu_set_b(t, i, 1000 + lcg(&x) % 1000);
+    }
+    for (int j = 0; j < columns; j++)
+        tableu_set_z(t, j, -(1.0 + lcg(&x) % 50));
+    return t;
+}
+
+/*
+ * wide(rows) with one more column, x_0, that enters first. Its ratios fall
+ * by 0.6 of the ratio test epsilon (1e-9) a row, so every row ties with its
+ * neighbours but not with the rows two away: a ratio test that compares
+ * each row to the best so far picks a row that depends on where the blocks
+ * start.
+ */
+static Tableu *ties(int rows){
+    const int columns = WIDTH * rows + 1;
+    RowType *types = calloc(rows, sizeof(RowType)); // All ROW_LE
+    Tableu *t = types ? tableu_create(rows, columns, types) : NULL;
+    free(types);
+    if (!t){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t x = 4242;
+    for (int i = 0; i < rows; i++){
+        tableu_set_a(t, i, 0, 1000);
+        for (int j = 1; j < columns; j++)
+            tableu_set_a(t, i, j, 1 + lcg(&x) % 100);
+        tableu_set_b(t, i, 1000 * (1 - 0.6e-9 * i));
+    }
+    tableu_set_z(t, 0, -1e4);
+    for (int j = 1; j < columns; j++)
+        tableu_set_z(t, j, -(1.0 + lcg(&x) % 50));
+    return t;
+}
+
+typedef struct Run{
+    SimplexStatus status;
+    double objective;
+    int pivots;
+    uint32_t basis;     // Hash of the final basis
+    double time;
+}Run;
+
+static Run solve(Tableu *(*lp)(int rows), int rows, const SimplexOptions *options){
+    Tableu *t = lp(rows);
+    double start = seconds();
+    Run run = {simplex_solve(t, options), 0.0, 0, 2166136261u, 0.0};
+    run.time = seconds() - start;
+    run.objective = simplex_objective(t);
+    run.pivots = t->iterations;
+    for (int i = 0; i < t->rows; i++)
+        run.basis = (run.basis ^ (uint32_t)t->basis_headers[i]) * 16777619u;
+    tableu_destroy(t);
+    return run;
+}
+
+static void print(const char *label, Run run, double serial){
+    printf("%-12s %9.4f s  speedup %5.2f  %6d pivots %9.1f us/pivot  %16.6f\n", label,
+           run.time, serial / run.time, run.pivots, run.time * 1e6 / run.pivots,
+           run.objective);
+}
+
+static const char *PRICING_NAMES[] = {"dantzig", "bland", "steepest", "devex"};
+
+/*
+ * Solves a wide dense LP serially and then on 1 .. max workers with every
+ * pricing rule but Bland. The parallel solves must reach the same objective
+ * in the same number of pivots. With segments > 1 the last lines price one
+ * segment of the columns per pivot, on max workers: more pivots, each one
+ * cheaper. The ties LP then has to end in the same basis on every number of
+ * workers.
+ */
+int main(int argc, char *argv[]){
+    int rows = argc > 1 ? atoi(argv[1]) : 300;
+    int max_workers = argc > 2 ? atoi(argv[2]) : 0;
+    int segments = argc > 3 ? atoi(argv[3]) : 8;
+    if (max_workers <= 0){
+        max_workers = ws_init(0);
+        ws_shutdown();
+    }
+    printf("%d x %d, tableau %.1f MB\n", rows, WIDTH * rows,
+           (double)rows * (WIDTH + 2) * rows * sizeof(double) / (1 << 20));
+
+    const Pricing rules[] = {PRICING_DANTZIG, PRICING_DEVEX, PRICING_STEEPEST_EDGE};
+    for (size_t k = 0; k < sizeof(rules) / sizeof(rules[0]); k++){
+        SimplexOptions options = SIMPLEX_DEFAULTS;
+        options.pricing = rules[k];
+        Run serial = solve(wide, rows, &options);
+        printf("\n%s\n", PRICING_NAMES[rules[k]]);
+        print("serial", serial, serial.time);
+
+        options.parallel = 1;
+        for (int workers = 1; workers <= max_workers; workers++){
+            if (ws_init(workers) < 0){
+                fprintf(stderr, "Error: could not start %d workers.\n", workers);
+                return EXIT_FAILURE;
+            }
+            Run run = solve(wide, rows, &options);
+            ws_shutdown();
+            if (run.status != serial.status || run.pivots != serial.pivots ||
+                fabs(run.objective - serial.objective) > 1e-6 * (1 + fabs(serial.objective))){
+                fprintf(stderr, "Error: %s on %d workers: %d pivots to %f, serial %d to %f.\n",
+                        PRICING_NAMES[rules[k]], workers, run.pivots, run.objective,
+                        serial.pivots, serial.objective);
+                return EXIT_FAILURE;
+            }
+            char label[32];
+            snprintf(label, sizeof(label), "%3d workers", workers);
+            print(label, run, serial.time);
+        }
+
+        if (segments > 1){
+            options.partial_pricing = segments;
+            if (ws_init(max_workers) < 0){
+                fprintf(stderr, "Error: could not start %d workers.\n", max_workers);
+                return EXIT_FAILURE;
+            }
+            Run run = solve(wide, rows, &options);
+            ws_shutdown();
+            if (fabs(run.objective - serial.objective) > 1e-6 * (1 + fabs(serial.objective))){
+                fprintf(stderr, "Error: %s with partial pricing: %f, serial %f.\n",
+                        PRICING_NAMES[rules[k]], run.objective, serial.objective);
+                return EXIT_FAILURE;
+            }
+            char label[32];
+            snprintf(label, sizeof(label), "partial %d", segments);
+            print(label, run, serial.time);
+        }
+    }
+
+    // Near ties across every block boundary: the same basis on any workers
+    SimplexOptions options = SIMPLEX_DEFAULTS;
+    Run serial = solve(ties, rows, &options);
+    printf("\nties\n");
+    print("serial", serial, serial.time);
+    options.parallel = 1;
+    for (int workers = 1; workers <= max_workers; workers++){
+        if (ws_init(workers) < 0){
+            fprintf(stderr, "Error: could not start %d workers.\n", workers);
+            return EXIT_FAILURE;
+        }
+        Run run = solve(ties, rows, &options);
+        ws_shutdown();
+        if (run.status != serial.status || run.pivots != serial.pivots ||
+            run.basis != serial.basis){
+            fprintf(stderr, "Error: ties on %d workers: %d pivots, serial %d, %s basis.\n",
+                    workers, run.pivots, serial.pivots,
+                    run.basis == serial.basis ? "same" : "different");
+            return EXIT_FAILURE;
+        }
+        char label[32];
+        snprintf(label, sizeof(label), "%3d workers", workers);
+        print(label, run, serial.time);
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+// cc -O2 sparse_bench.c revised.c simplex.c simplex_data.c -lm -o sparse_bench
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#include "revised.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Sparse revised simplex against the dense tableau on sparse LPs:
+ *
+ *   transport_n     n x n transportation problem, 2 nonzeros per column
+ *   random_m        m <= rows, 2m columns, 4 nonzeros per column
+ *   planning_t      t period production planning, inventory balance rows
+ *
+ * The dense solver is skipped once its tableau would pass DENSE_LIMIT.
+ */
+
+#define DENSE_LIMIT (16u << 20)
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *checked_malloc(size_t bytes){
+    void *p = malloc(bytes);
+    if (!p){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static uint32_t lcg(uint32_t *x){
+    *x = *x * 1664525u + 1013904223u;
+    return *x >> 8;
+}
+
+// An LP as triplets, loaded into either solver
+typedef struct Problem{
+    int rows;
+    int columns;
+    RowType *types;
+    double *b;
+    double *c;
+    int nonzeros;
+    int capacity;
+    int *entry_rows;
+    int *entry_columns;
+    double *entry_values;
+}Problem;
+
+static Problem problem_create(int rows, int columns, int capacity){
+    Problem p = {rows, columns, checked_malloc(sizeof(RowType) * rows),
+                 calloc(rows, sizeof(double)), calloc(columns, sizeof(double)),
+                 0, capacity, checked_malloc(sizeof(int) * capacity),
+                 checked_malloc(sizeof(int) * capacity),
+                 checked_malloc(sizeof(double) * capacity)};
+    if (!p.b || !p.c){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void problem_add(Problem *p, int i, int j, double v){
+    p->entry_rows[p->nonzeros] = i;
+    p->entry_columns[p->nonzeros] = j;
+    p->entry_values[p->nonzeros++] = v;
+}
+
+static void problem_destroy(Problem *p){
+    free(p->types);
+    free(p->b);
+    free(p->c);
+    free(p->entry_rows);
+    free(p->entry_columns);
+    free(p->entry_values);
+}
+
+// n suppliers, n customers, balanced supply and demand
+static Problem transport(int n){
+    Problem p = problem_create(2 * n, n * n, 2 * n * n);
+    uint32_t x = 7;
+    double total = 0;
+    for (int i = 0; i < n; i++){
+        p.types[i] = p.types[n + i] = ROW_EQ;
+        p.b[i] = 10 + lcg(&x) % 90;
+        total += p.b[i];
+    }
+    double left = total;
+    for (int j = 0; j < n; j++){
+        p.b[n + j] = j == n - 1 ? left : floor(total / n);
+        left -= p.b[n + j];
+    }
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            problem_add(&p, i, i * n + j, 1);
+            problem_add(&p, n + j, i * n + j, 1);
+            p.c[i * n + j] = 1 + lcg(&x) % 20;
+        }
+    }
+    return p;
+}
+
+// max c x  s.t.  A x <= b, 4 random positive entries per column
+static Problem random_sparse(int m){
+    const int n = 2 * m;
+    Problem p = problem_create(m, n, 4 * n);
+    uint32_t x = 12345;
+    for (int i = 0; i < m; i++){
+        p.types[i] = ROW_LE;
+        p.b[i] = 100 + lcg(&x) % 900;
+    }
+    for (int j = 0; j < n; j++){
+        for (int k = 0; k < 4; k++)
+            problem_add(&p, lcg(&x) % m, j, 1 + lcg(&x) % 9);
+        p.c[j] = -(1.0 + lcg(&x) % 20);
+    }
+    return p;
+}
+
+/*
+ * Periods k = 0..t-1 with production x_k <= capacity, inventory s_k and
+ *   x_k + s_{k-1} - s_k = demand_k
+ * minimizing production plus holding costs. Columns: x then s.
+ */
+static Problem planning(int t){
+    Problem p = problem_create(2 * t, 2 * t, 4 * t);
+    uint32_t x = 99;
+    for (int k = 0; k < t; k++){
+        p.types[k] = ROW_EQ;
+        p.b[k] = 20 + lcg(&x) % 60;
+        p.types[t + k] = ROW_LE;
+        p.b[t + k] = 90;
+        problem_add(&p, k, k, 1);
+        problem_add(&p, t + k, k, 1);
+        if (k > 0)
+            problem_add(&p, k, t + k - 1, 1);
+        problem_add(&p, k, t + k, -1);
+        p.c[k] = 5 + lcg(&x) % 10;
+        p.c[t + k] = 1;
+    }
+    return p;
+}
+
+static const char *STATUS_NAMES[] = {"optimal", "infeasible", "unbounded", "limit",
+                                     "overflow", "singular", "memory"};
+
+static void run(const char *name, Problem p){
+    SparseLP *lp = sparse_create(p.rows, p.columns, p.types, p.nonzeros);
+    if (!lp){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < p.nonzeros; k++)
+        sparse_add(lp, p.entry_rows[k], p.entry_columns[k], p.entry_values[k]);
+    for (int i = 0; i < p.rows; i++)
+        sparse_set_b(lp, i, p.b[i]);
+    for (int j = 0; j < p.columns; j++)
+        sparse_set_z(lp, j, p.c[j]);
+    double start = now_seconds();
+    SimplexStatus status = sparse_solve(lp, NULL);
+    double seconds = now_seconds() - start;
+    printf("%-14s %6d x %-6d %8d nz  sparse %-9s %16.6f %6d pivots %4d lu %10.3f ms\n",
+           name, p.rows, p.columns, p.nonzeros, STATUS_NAMES[status],
+           sparse_objective(lp), lp->iterations, lp->refactorizations,
+           seconds * 1e3);
+    fflush(stdout);
+    sparse_destroy(lp);
+
+    // Dense tableau of the same problem, when it fits
+    double bytes = (double)p.rows * (2.0 * p.rows + p.columns) * sizeof(double);
+    if (bytes > DENSE_LIMIT){
+        printf("%-14s %6s   %-6s %8s     dense  skipped, the tableau would take %.0f MB\n",
+               "", "", "", "", bytes / (1 << 20));
+        problem_destroy(&p);
+        return;
+    }
+    Tableu *t = tableu_create(p.rows, p.columns, p.types);
+    if (!t){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < p.nonzeros; k++)
+        tableu_row(t, p.entry_rows[k])[p.entry_columns[k]] += p.entry_values[k];
+    for (int i = 0; i < p.rows; i++)
+        tableu_set_b(t, i, p.b[i]);
+    for (int j = 0; j < p.columns; j++)
+        tableu_set_z(t, j, p.c[j]);
+    start = now_seconds();
+    status = simplex_solve(t, NULL);
+    seconds = now_seconds() - start;
+    printf("%-14s %6s   %-6s %8s     dense  %-9s %16.6f %6d pivots %7s %10.3f ms\n",
+           "", "", "", "", STATUS_NAMES[status], simplex_objective(t),
+           t->iterations, "", seconds * 1e3);
+    tableu_destroy(t);
+    problem_destroy(&p);
+}
+
+int main(void){
+    run("transport_10", transport(10));
+    run("transport_40", transport(40));
+    run("random_200", random_sparse(200));
+    run("random_1000", random_sparse(1000));
+    run("planning_200", planning(200));
+    run("planning_5000", planning(5000));
+    return 0;
+}
@@ -1,94 +1,601 @@
+#include "value.h"
+#include <inttypes.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-typedef struct Fractional{
-    long numerator;
-    long denominator;
-}Fractional;
+typedef __int128 wide;
+typedef unsigned __int128 uwide;
 
-// Uses gcd algorithm to set the lowest values to numerator and denominator
-void gcd_shrink(Fractional *f){
-    if(f->numerator == 0){
-        f->denominator = 1;
+/*
+ * Arbitrary precision integers for promoted values: sign and magnitude, 32
+ * bit limbs, least significant first, no leading zero limbs. Zero has length
+ * 0. Every Big owns its limbs except the views of small values.
+ */
+typedef struct Big{
+    int negative;
+    int length;
+    uint32_t *limbs;
+}Big;
+
+struct BigRational{
+    Big numerator;
+    Big denominator;            // > 0, coprime to the numerator
+};
+
+static void *checked_calloc(size_t count, size_t size){
+    void *p = calloc(count ? count : 1, size);
+    if(!p){
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static Big big_alloc(int length){
+    Big a = {0, length, checked_calloc((size_t)length, sizeof(uint32_t))};
+    return a;
+}
+
+static void big_free(Big *a){
+    free(a->limbs);
+    a->limbs = NULL;
+    a->length = 0;
+}
+
+static void big_trim(Big *a){
+    while(a->length > 0 && a->limbs[a->length - 1] == 0){
+        a->length--;
+    }
+    if(a->length == 0){
+        a->negative = 0;
+    }
+}
+
+// Magnitude m into the limbs of a, which must hold 4
+static void big_set(Big *a, uwide m, int negative){
+    a->length = 4;
+    for(int i = 0; i < 4; i++){
+        a->limbs[i] = (uint32_t)(m >> (32 * i));
+    }
+    a->negative = negative;
+    big_trim(a);
+}
+
+static Big big_from_wide(uwide m, int negative){
+    Big a = big_alloc(4);
+    big_set(&a, m, negative);
+    return a;
+}
+
+static Big big_copy(const Big *a){
+    Big c = big_alloc(a->length);
+    c.negative = a->negative;
+    memcpy(c.limbs, a->limbs, (size_t)a->length * sizeof(uint32_t));
+    return c;
+}
+
+// Magnitude if it fits in 128 bits
+static int big_to_wide(const Big *a, uwide *m){
+    if(a->length > 4){
+        return 0;
+    }
+    *m = 0;
+    for(int i = a->length - 1; i >= 0; i--){
+        *m = *m << 32 | a->limbs[i];
+    }
+    return 1;
+}
+
+static int big_compare_magnitude(const Big *a, const Big *b){
+    if(a->length != b->length){
+        return a->length < b->length ? -1 : 1;
+    }
+    for(int i = a->length - 1; i >= 0; i--){
+        if(a->limbs[i] != b->limbs[i]){
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static Big big_add_magnitude(const Big *a, const Big *b){
+    if(a->length < b->length){
+        const Big *t = a;
+        a = b;
+        b = t;
+    }
+    Big r = big_alloc(a->length + 1);
+    uint64_t carry = 0;
+    for(int i = 0; i < a->length; i++){
+        carry += (uint64_t)a->limbs[i] + (i < b->length ? b->limbs[i] : 0);
+        r.limbs[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    r.limbs[a->length] = (uint32_t)carry;
+    big_trim(&r);
+    return r;
+}
+
+// a -= b in place, |a| >= |b|
+static void big_subtract_in_place(Big *a, const Big *b){
+    int64_t borrow = 0;
+    for(int i = 0; i < a->length; i++){
+        borrow += (int64_t)a->limbs[i] - (i < b->length ? b->limbs[i] : 0);
+        a->limbs[i] = (uint32_t)borrow;
+        borrow >>= 32;
+    }
+    int negative = a->negative;
+    big_trim(a);
+    a->negative = a->length ? negative : 0;
+}
+
+// a + b, or a - b when subtract is set
+static Big big_add(const Big *a, const Big *b, int subtract){
+    int b_negative = b->negative ^ (subtract && b->length);
+    if(a->negative == b_negative){
+        Big r = big_add_magnitude(a, b);
+        r.negative = r.length ? a->negative : 0;
+        return r;
+    }
+    // Different signs: the larger magnitude minus the smaller
+    if(big_compare_magnitude(a, b) >= 0){
+        Big r = big_copy(a);
+        big_subtract_in_place(&r, b);
+        return r;
+    }
+    Big r = big_copy(b);
+    r.negative = b_negative;
+    big_subtract_in_place(&r, a);
+    return r;
+}
+
+static Big big_mul(const Big *a, const Big *b){
+    if(a->length == 0 || b->length == 0){
+        return big_alloc(0);
+    }
+    Big r = big_alloc(a->length + b->length);
+    for(int i = 0; i < a->length; i++){
+        uint64_t carry = 0;
+        for(int j = 0; j < b->length; j++){
+            carry += (uint64_t)a->limbs[i] * b->limbs[j] + r.limbs[i + j];
+            r.limbs[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        r.limbs[i + b->length] = (uint32_t)carry;
+    }
+    r.negative = a->negative ^ b->negative;
+    big_trim(&r);
+    return r;
+}
+
+static int big_trailing_zeros(const Big *a){
+    int i = 0;
+    while(a->limbs[i] == 0){
+        i++;
+    }
+    return 32 * i + __builtin_ctz(a->limbs[i]);
+}
+
+static void big_shift_right(Big *a, int bits){
+    int limbs = bits / 32;
+    bits %= 32;
+    for(int i = 0; i + limbs < a->length; i++){
+        uint64_t v = a->limbs[i + limbs];
+        if(i + limbs + 1 < a->length){
+            v |= (uint64_t)a->limbs[i + limbs + 1] << 32;
+        }
+        a->limbs[i] = (uint32_t)(v >> bits);
+    }
+    a->length -= limbs;
+    big_trim(a);
+}
+
+static Big big_shift_left(const Big *a, int bits){
+    int limbs = bits / 32;
+    bits %= 32;
+    Big r = big_alloc(a->length + limbs + 1);
+    for(int i = 0; i < a->length; i++){
+        uint64_t v = (uint64_t)a->limbs[i] << bits;
+        r.limbs[i + limbs] |= (uint32_t)v;
+        r.limbs[i + limbs + 1] = (uint32_t)(v >> 32);
+    }
+    r.negative = a->negative;
+    big_trim(&r);
+    return r;
+}
+
+// Stein's binary gcd, the swap as conditional moves so it does not branch
+static uint64_t gcd64(uint64_t u, uint64_t v){
+    if(u == 0){
+        return v;
+    }
+    if(v == 0){
+        return u;
+    }
+    int shift = __builtin_ctzll(u | v);
+    u >>= __builtin_ctzll(u);
+    v >>= __builtin_ctzll(v);
+    while(u != v){
+        uint64_t d = u > v ? u - v : v - u;
+        u = u < v ? u : v;
+        v = d >> __builtin_ctzll(d);
+    }
+    return u << shift;
+}
+
+static int ctz128(uwide x){
+    uint64_t low = (uint64_t)x;
+    return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(x >> 64));
+}
+
+static uwide gcd128(uwide u, uwide v){
+    if(u == 0){
+        return v;
+    }
+    if(v == 0){
+        return u;
+    }
+    int shift = ctz128(u | v);
+    u >>= ctz128(u);
+    do{
+        v >>= ctz128(v);
+        // Finish in 64 bits once both fit
+        if((u >> 64) == 0 && (v >> 64) == 0){
+            return (uwide)gcd64((uint64_t)u, (uint64_t)v) << shift;
+        }
+        if(u > v){
+            uwide t = u;
+            u = v;
+            v = t;
+        }
+        v -= u;
+    }while(v != 0);
+    return u << shift;
+}
+
+// Binary gcd of the magnitudes, both nonzero
+static Big big_gcd(const Big *a, const Big *b){
+    uwide x, y;
+    if(big_to_wide(a, &x) && big_to_wide(b, &y)){
+        return big_from_wide(gcd128(x, y), 0);
+    }
+    Big u = big_copy(a);
+    Big v = big_copy(b);
+    u.negative = v.negative = 0;
+    int zu = big_trailing_zeros(&u);
+    int zv = big_trailing_zeros(&v);
+    int shift = zu < zv ? zu : zv;
+    big_shift_right(&u, zu);
+    do{
+        big_shift_right(&v, big_trailing_zeros(&v));
+        if(big_compare_magnitude(&u, &v) > 0){
+            Big t = u;
+            u = v;
+            v = t;
+        }
+        big_subtract_in_place(&v, &u);
+    }while(v.length != 0);
+    big_free(&v);
+    Big g = big_shift_left(&u, shift);
+    big_free(&u);
+    return g;
+}
+
+// a /= d in place for one limb d, returns the remainder
+static uint32_t big_divide_limb(Big *a, uint32_t d){
+    uint64_t r = 0;
+    for(int i = a->length - 1; i >= 0; i--){
+        uint64_t v = r << 32 | a->limbs[i];
+        a->limbs[i] = (uint32_t)(v / d);
+        r = v % d;
+    }
+    int negative = a->negative;
+    big_trim(a);
+    a->negative = a->length ? negative : 0;
+    return (uint32_t)r;
+}
+
+// a / d where d divides a, shift and subtract for long divisors
+static Big big_divide_exact(const Big *a, const Big *d){
+    Big q = big_copy(a);
+    q.negative = a->negative ^ d->negative;
+    if(d->length == 1){
+        big_divide_limb(&q, d->limbs[0]);
+        return q;
+    }
+    memset(q.limbs, 0, (size_t)q.length * sizeof(uint32_t));
+    Big r = big_alloc(d->length + 1);
+    Big divisor = *d;
+    divisor.negative = 0;
+    r.length = 0;
+    for(int bit = 32 * a->length - 1; bit >= 0; bit--){
+        // r = 2 r + next bit of a
+        uint32_t carry = a->limbs[bit / 32] >> (bit % 32) & 1;
+        for(int i = 0; i < r.length; i++){
+            uint32_t top = r.limbs[i] >> 31;
+            r.limbs[i] = r.limbs[i] << 1 | carry;
+            carry = top;
+        }
+        if(carry){
+            r.limbs[r.length++] = carry;
+        }
+        if(big_compare_magnitude(&r, &divisor) >= 0){
+            big_subtract_in_place(&r, &divisor);
+            q.limbs[bit / 32] |= 1u << (bit % 32);
+        }
+    }
+    big_free(&r);
+    big_trim(&q);
+    return q;
+}
+
+// Top bits of a as mantissa * 2^exponent
+static double big_to_double(const Big *a, int *exponent){
+    double m = 0;
+    int top = a->length < 3 ? a->length : 3;
+    for(int i = a->length - 1; i >= a->length - top; i--){
+        m = m * 4294967296.0 + a->limbs[i];
+    }
+    *exponent = 32 * (a->length - top);
+    return a->negative ? -m : m;
+}
+
+static void big_print(FILE *out, const Big *a){
+    if(a->length == 0){
+        fputc('0', out);
+        return;
+    }
+    // Base 10^9 digits, least significant first
+    Big t = big_copy(a);
+    uint32_t *digits = checked_calloc((size_t)t.length * 10 / 9 + 2, sizeof(uint32_t));
+    int count = 0;
+    while(t.length){
+        digits[count++] = big_divide_limb(&t, 1000000000u);
+    }
+    fprintf(out, "%s%u", a->negative ? "-" : "", digits[count - 1]);
+    for(int i = count - 2; i >= 0; i--){
+        fprintf(out, "%09u", digits[i]);
+    }
+    free(digits);
+    big_free(&t);
+}
+
+// Numerator and denominator of f, views into storage for small values
+static void big_view(const Fractional *f, Big *n, Big *d, uint32_t storage[8]){
+    if(f->big){
+        *n = f->big->numerator;
+        *d = f->big->denominator;
         return;
     }
+    n->limbs = storage;
+    d->limbs = storage + 4;
+    int64_t x = f->numerator;
+    int64_t y = f->denominator;
+    big_set(n, x < 0 ? -(uwide)x : (uwide)x, x < 0);
+    big_set(d, y < 0 ? -(uwide)y : (uwide)y, y < 0);
+}
+
+static int fits_int64(uwide magnitude, int negative){
+    return magnitude <= (uwide)INT64_MAX + (negative ? 1 : 0);
+}
 
-    long gcd = 1;
-    long x = f->numerator;
-    long y = f->denominator;
-    if(x < 0){
-        x = 0 - x;
+// Reduced n / d from owned bigs, demoted if it fits
+static Fractional big_fraction(Big n, Big d){
+    if(d.negative){
+        d.negative = 0;
+        n.negative = n.length ? !n.negative : 0;
     }
-    if (x < y){
-        long tmp = x;
-        x = y;
-        y = tmp;
+    Fractional res = {0, 1, NULL};
+    if(n.length == 0){
+        big_free(&n);
+        big_free(&d);
+        return res;
     }
+    Big g = big_gcd(&n, &d);
+    if(!(g.length == 1 && g.limbs[0] == 1)){
+        Big rn = big_divide_exact(&n, &g);
+        Big rd = big_divide_exact(&d, &g);
+        big_free(&n);
+        big_free(&d);
+        n = rn;
+        d = rd;
+    }
+    big_free(&g);
+    uwide x, y;
+    if(big_to_wide(&n, &x) && big_to_wide(&d, &y) &&
+       fits_int64(x, n.negative) && fits_int64(y, 0)){
+        res.numerator = n.negative ? (int64_t)-x : (int64_t)x;
+        res.denominator = (int64_t)y;
+        big_free(&n);
+        big_free(&d);
+        return res;
+    }
+    res.numerator = 0;
+    res.denominator = 0;
+    res.big = checked_calloc(1, sizeof(BigRational));
+    res.big->numerator = n;
+    res.big->denominator = d;
+    return res;
+}
 
-    // INVARIANT:
-    // numerator + denominator == (x + y) * gcd
-    while(y != 0){
-        gcd = y;
-        y = x % gcd;
-        x = gcd;
+// Reduced n / d from 128 bit intermediates, promoted if it does not fit
+static Fractional wide_fraction(wide n, wide d){
+    int negative = (n < 0) != (d < 0);
+    uwide x = n < 0 ? -(uwide)n : (uwide)n;
+    uwide y = d < 0 ? -(uwide)d : (uwide)d;
+    Fractional res = {0, 1, NULL};
+    if(x == 0){
+        return res;
     }
-    f->numerator = f->numerator / gcd;
-    f->denominator = f->denominator / gcd;
+    if((x >> 64) == 0 && (y >> 64) == 0){
+        uint64_t g = gcd64((uint64_t)x, (uint64_t)y);
+        x = (uint64_t)x / g;
+        y = (uint64_t)y / g;
+    } else {
+        uwide g = gcd128(x, y);
+        x /= g;
+        y /= g;
+    }
+    if(fits_int64(x, negative) && fits_int64(y, 0)){
+        res.numerator = negative ? (int64_t)-x : (int64_t)x;
+        res.denominator = (int64_t)y;
+        return res;
+    }
+    res.numerator = 0;
+    res.denominator = 0;
+    res.big = checked_calloc(1, sizeof(BigRational));
+    res.big->numerator = big_from_wide(x, negative);
+    res.big->denominator = big_from_wide(y, 0);
+    return res;
+}
+
+// Reduces to lowest terms with a positive denominator
+void gcd_shrink(Fractional *f){
+    if(f->big){
+        return;
+    }
+    *f = wide_fraction(f->numerator, f->denominator);
+}
+
+// a.n b.d + b.n a.d (or minus) over a.d b.d, in bigs
+static Fractional big_add_fractions(const Fractional *a, const Fractional *b, int subtract){
+    uint32_t sa[8], sb[8];
+    Big an, ad, bn, bd;
+    big_view(a, &an, &ad, sa);
+    big_view(b, &bn, &bd, sb);
+    Big x = big_mul(&an, &bd);
+    Big y = big_mul(&bn, &ad);
+    Big n = big_add(&x, &y, subtract);
+    big_free(&x);
+    big_free(&y);
+    return big_fraction(n, big_mul(&ad, &bd));
 }
 
 // Addition of two fractional values, returns a new Fractional with the result
 Fractional fadd(const Fractional *a, const Fractional *b){
-    long numerator = (a->numerator*b->denominator)+(b->numerator*a->denominator);
-    long denominator = a->denominator*b->denominator;
-    Fractional res = {numerator, denominator};
-    gcd_shrink(&res);
-    return res;
+    if(a->big || b->big){
+        return big_add_fractions(a, b, 0);
+    }
+    wide numerator = (wide)a->numerator * b->denominator + (wide)b->numerator * a->denominator;
+    wide denominator = (wide)a->denominator * b->denominator;
+    return wide_fraction(numerator, denominator);
 }
 
 // Subtraction of two fractional values, returns a new Fractional with the result
 Fractional fsub(const Fractional *a, const Fractional *b){
-    long numerator = (a->numerator*b->denominator)-(b->numerator*a->denominator);
-    long denominator = a->denominator*b->denominator;
-    Fractional res = {numerator, denominator};
-    gcd_shrink(&res);
-    return res;
+    if(a->big || b->big){
+        return big_add_fractions(a, b, 1);
+    }
+    wide numerator = (wide)a->numerator * b->denominator - (wide)b->numerator * a->denominator;
+    wide denominator = (wide)a->denominator * b->denominator;
+    return wide_fraction(numerator, denominator);
+}
+
+// n = a.x * b.y, d = a.z * b.w where x, y, z, w pick numerators or denominators
+static Fractional big_mul_fractions(const Fractional *a, const Fractional *b, int divide){
+    uint32_t sa[8], sb[8];
+    Big an, ad, bn, bd;
+    big_view(a, &an, &ad, sa);
+    big_view(b, &bn, &bd, sb);
+    Big n = big_mul(&an, divide ? &bd : &bn);
+    Big d = big_mul(&ad, divide ? &bn : &bd);
+    return big_fraction(n, d);
 }
 
 Fractional fmul(const Fractional *a, const Fractional *b){
-    long numerator = a->numerator*b->numerator;
-    long denominator = a->denominator*b->denominator;
-    Fractional res = {numerator, denominator};
-    gcd_shrink(&res);
-    return res;
+    if(a->big || b->big){
+        return big_mul_fractions(a, b, 0);
+    }
+    wide numerator = (wide)a->numerator * b->numerator;
+    wide denominator = (wide)a->denominator * b->denominator;
+    return wide_fraction(numerator, denominator);
 }
 
 // a / b = res
 Fractional fdiv(const Fractional *a, const Fractional *b){
-    if(b->numerator == 0){
+    if(b->big ? b->big->numerator.length == 0 : b->numerator == 0){
         fprintf(stderr, "Error: Division by zero.\n");
         exit(EXIT_FAILURE);
     }
-    long numerator = a->numerator*b->denominator;
-    long denominator = a->denominator*b->numerator;
-    Fractional res = {numerator, denominator};
-    gcd_shrink(&res);
-    return res;
+    if(a->big || b->big){
+        return big_mul_fractions(a, b, 1);
+    }
+    wide numerator = (wide)a->numerator * b->denominator;
+    wide denominator = (wide)a->denominator * b->numerator;
+    return wide_fraction(numerator, denominator);
 }
 
 double get_double_value(const Fractional *f){
+    if(f->big){
+        int en, ed;
+        double n = big_to_double(&f->big->numerator, &en);
+        double d = big_to_double(&f->big->denominator, &ed);
+        return ldexp(n / d, en - ed);
+    }
     return ((double)f->numerator/f->denominator);
 }
 
+void ffree(Fractional *f){
+    if(f->big){
+        big_free(&f->big->numerator);
+        big_free(&f->big->denominator);
+        free(f->big);
+    }
+    f->numerator = 0;
+    f->denominator = 1;
+    f->big = NULL;
+}
+
+Fractional fcopy(const Fractional *f){
+    Fractional c = *f;
+    if(f->big){
+        c.big = checked_calloc(1, sizeof(BigRational));
+        c.big->numerator = big_copy(&f->big->numerator);
+        c.big->denominator = big_copy(&f->big->denominator);
+    }
+    return c;
+}
+
+int fcompare(const Fractional *a, const Fractional *b){
+    if(!a->big && !b->big){
+        // Cross multiply with the denominators made positive
+        wide x = (wide)a->numerator * b->denominator;
+        wide y = (wide)b->numerator * a->denominator;
+        if((a->denominator < 0) != (b->denominator < 0)){
+            x = -x;
+            y = -y;
+        }
+        return (x > y) - (x < y);
+    }
+    Fractional d = fsub(a, b);
+    int sign = d.big ? (d.big->numerator.negative ? -1 : 1)
+                     : (d.numerator > 0) - (d.numerator < 0);
+    ffree(&d);
+    return sign;
+}
+
+void fprint_value(FILE *out, const Fractional *f){
+    if(f->big){
+        big_print(out, &f->big->numerator);
+        fputc('/', out);
+        big_print(out, &f->big->denominator);
+        return;
+    }
+    fprintf(out, "%lld/%lld", (long long)f->numerator, (long long)f->denominator);
+}
+
 
 /**
  * TESTS
 */
 
 void test_fadd(){
-    Fractional value_a = {1,2};
-    Fractional value_b = {1,2};
+    Fractional value_a = {1,2,NULL};
+    Fractional value_b = {1,2,NULL};
     Fractional sum = fadd(&value_a,&value_b);
-    printf("%ld/%ld\n",sum.numerator,sum.denominator);
+    printf("%" PRId64 "/%" PRId64 "\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
     value_a.numerator = 4;
@@ -96,7 +603,7 @@ void test_fadd(){
     value_b.numerator = 3;
     value_b.denominator = 2;
     sum = fadd(&value_a,&value_b);
-    printf("%ld/%ld\n",sum.numerator,sum.denominator);
+    printf("%" PRId64 "/%" PRId64 "\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
     value_a.numerator = 4;
@@ -104,118 +611,121 @@ void test_fadd(){
     value_b.numerator = 5;
     value_b.denominator = 3;
     sum = fadd(&value_a,&value_b);
-    printf("%ld/%ld\n",sum.numerator,sum.denominator);
+    printf("%" PRId64 "/%" PRId64 "\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
 }
 
 void test_fsub(){
-    Fractional value_a = {1,2};
-    Fractional value_b = {1,2};
-    printf("Testing: (%ld/%ld) - (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    Fractional value_a = {1,2,NULL};
+    Fractional value_b = {1,2,NULL};
+    printf("Testing: (%" PRId64 "/%" PRId64 ") - (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     Fractional sum = fsub(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
     value_a.numerator = 4;
     value_a.denominator = 1;
     value_b.numerator = 3;
     value_b.denominator = 2;
-    printf("Testing: (%ld/%ld) - (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") - (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     sum = fsub(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
     value_a.numerator = 4;
     value_a.denominator = 3;
     value_b.numerator = 5;
     value_b.denominator = 3;
-    printf("Testing: (%ld/%ld) - (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") - (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     sum = fsub(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 }
 
 void test_fmul(){
-    Fractional value_a = {1,2};
-    Fractional value_b = {1,2};
-    printf("Testing: (%ld/%ld) * (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    Fractional value_a = {1,2,NULL};
+    Fractional value_b = {1,2,NULL};
+    printf("Testing: (%" PRId64 "/%" PRId64 ") * (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     Fractional sum = fmul(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
     value_a.numerator = 4;
     value_a.denominator = 1;
     value_b.numerator = 3;
     value_b.denominator = 2;
-    printf("Testing: (%ld/%ld) * (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") * (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     sum = fmul(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
     value_a.numerator = 4;
     value_a.denominator = 3;
     value_b.numerator = 5;
     value_b.denominator = 3;
-    printf("Testing: (%ld/%ld) * (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") * (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     sum = fmul(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 }
 void test_fdiv(){
-    Fractional value_a = {1,2};
-    Fractional value_b = {1,2};
-    printf("Testing: (%ld/%ld) / (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    Fractional value_a = {1,2,NULL};
+    Fractional value_b = {1,2,NULL};
+    printf("Testing: (%" PRId64 "/%" PRId64 ") / (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     Fractional sum = fdiv(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
     value_a.numerator = 4;
     value_a.denominator = 1;
     value_b.numerator = 3;
     value_b.denominator = 2;
-    printf("Testing: (%ld/%ld) / (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") / (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     sum = fdiv(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
     value_a.numerator = 4;
     value_a.denominator = 3;
     value_b.numerator = 5;
     value_b.denominator = 3;
-    printf("Testing: (%ld/%ld) / (%ld/%ld)",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") / (%" PRId64 "/%" PRId64 ")",value_a.numerator,value_a.denominator,value_b.numerator,value_b.denominator);
     sum = fdiv(&value_a,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 }
 
 void test_error(){
-    Fractional value_a = {1,2};
-    Fractional value_b = {1,2};
+    Fractional value_a = {1,2,NULL};
+    Fractional value_b = {1,2,NULL};
     Fractional sum = fadd(&value_a,&value_b);
-    printf("%ld/%ld\n",sum.numerator,sum.denominator);
+    printf("%" PRId64 "/%" PRId64 "\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
-    printf("Testing: (%ld/%ld) - (%ld/%ld)",sum.numerator,sum.denominator,value_b.numerator,value_b.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") - (%" PRId64 "/%" PRId64 ")",sum.numerator,sum.denominator,value_b.numerator,value_b.denominator);
     sum = fsub(&sum,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
-    printf("Testing: (%ld/%ld) - (%ld/%ld)",sum.numerator,sum.denominator,value_b.numerator,value_b.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") - (%" PRId64 "/%" PRId64 ")",sum.numerator,sum.denominator,value_b.numerator,value_b.denominator);
     sum = fsub(&sum,&value_b);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 
-    printf("Testing: (%ld/%ld) / (%ld/%ld)",value_b.numerator,value_b.denominator,sum.numerator,sum.denominator);
+    printf("Testing: (%" PRId64 "/%" PRId64 ") / (%" PRId64 "/%" PRId64 ")",value_b.numerator,value_b.denominator,sum.numerator,sum.denominator);
     sum = fdiv(&value_b,&sum);
-    printf(" = (%ld/%ld)\n",sum.numerator,sum.denominator);
+    printf(" = (%" PRId64 "/%" PRId64 ")\n",sum.numerator,sum.denominator);
     printf("Double: %.2f\n",get_double_value(&sum));
 }
 
+// Built with -DVALUE_NO_MAIN when linked into other programs
+#ifndef VALUE_NO_MAIN
 int main(int argc, char **argv){
     // test_fadd();
     // test_fsub();
     // test_fmul();
     // test_fdiv();
     // test_error();
-}
\ No newline at end of file
+}
+#endif
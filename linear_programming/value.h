@@ -0,0 +1,44 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct BigRational BigRational;
+
+/*
+ * Exact rational. Small values are numerator / denominator in 64 bits on
+ * every target (long is 32 bits on wasm32). The ops compute with 128 bit
+ * intermediates, so they never wrap: a result that does not fit in 64 bits
+ * is promoted to an arbitrary precision BigRational in big, and demoted back
+ * as soon as a later result fits again.
+ *
+ * numerator and denominator are only meaningful while big is NULL. A result
+ * owns its big part: release values that may have been promoted with ffree,
+ * duplicate them with fcopy. Values built as {n, d} are small.
+ */
+typedef struct Fractional{
+    int64_t numerator;
+    int64_t denominator;
+    BigRational *big;
+}Fractional;
+
+// Reduces to lowest terms with a positive denominator (binary gcd)
+void gcd_shrink(Fractional *f);
+Fractional fadd(const Fractional *a, const Fractional *b);
+Fractional fsub(const Fractional *a, const Fractional *b);
+Fractional fmul(const Fractional *a, const Fractional *b);
+// a / b = res, exits on division by zero
+Fractional fdiv(const Fractional *a, const Fractional *b);
+double get_double_value(const Fractional *f);
+
+// Frees the big part of a promoted value, f becomes 0
+void ffree(Fractional *f);
+// Deep copy, the big part included
+Fractional fcopy(const Fractional *f);
+// -1, 0 or 1 as a < b, a == b or a > b
+int fcompare(const Fractional *a, const Fractional *b);
+// Writes f as n/d in decimal, big values included
+void fprint_value(FILE *out, const Fractional *f);
+
+#endif
@@ -0,0 +1,214 @@
+#include "checkpoint.h"
+#include "integrator.h"
+#include "montecarlo.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/*
+ * Headless benchmark of the sampler, no window or font needed. Runs a fixed
+ * sample budget and/or a wall-clock duration and prints one JSON object:
+ *
+ *   mcp_bench [--samples n] [--seconds s] [--threads n] [--seed n]
+ *             [--batch n] [--mode random|sobol|halton|stratified|antithetic]
+ *             [--checkpoint file]
+ *   mcp_bench --problem name [--samples n] [--seconds s] [--seed n]
+ *             [--batch n]
+ *
+ * Defaults to 1e9 random samples. Samples are plotted on the same 400x400
+ * RGBA grid as the viewer, so the numbers include writing the sample words.
+ * With --checkpoint the run continues from file if it exists, --samples and
+ * --seconds then count the samples added, and the state is written back at
+ * the end.
+ *
+ * --problem runs one of the integration problems below through the generic
+ * integrate<Region>() engine on the calling thread instead, to compare the
+ * cost of other integrands with the Pi sampler. --threads, --mode and
+ * --checkpoint only apply to the Pi sampler and are rejected with it.
+ */
+
+struct Parabola {
+  float operator()(float x) const { return 1.0F - x * x; }
+};
+struct Superellipse {
+  bool operator()(const float *x) const {
+    float a = x[0] * x[0];
+    float b = x[1] * x[1];
+    return a * a + b * b <= 1.0F;
+  }
+};
+
+static const UnitBall<2> DISK;
+static const UnitBall<3> BALL3;
+static const UnitBall<4> BALL4;
+static const UnitBall<5> BALL5;
+static const UnderGraph<Parabola> PARABOLA(Parabola(), -1.0F, 1.0F, 1.0F);
+static const Implicit<2, Superellipse>
+    SUPERELLIPSE(Bounds<2>{{-1.0F, -1.0F}, {1.0F, 1.0F}}, Superellipse());
+
+template <const auto &Region>
+static uint64_t regionHits(uint64_t seed, uint64_t first, size_t count) {
+  return integrate(Region, seed, first, count);
+}
+
+struct Problem {
+  const char *name;
+  double exact;
+  double volume;
+  uint64_t (*hits)(uint64_t seed, uint64_t first, size_t count);
+};
+
+// Volume of the unit n-ball
+static double ballVolume(int n) {
+  return std::pow(M_PI, n / 2.0) / std::tgamma(n / 2.0 + 1.0);
+}
+
+static const Problem *findProblem(const char *name) {
+  static const Problem problems[] = {
+      {"disk", M_PI, DISK.bounds.volume(), regionHits<DISK>},
+      {"ball3", ballVolume(3), BALL3.bounds.volume(), regionHits<BALL3>},
+      {"ball4", ballVolume(4), BALL4.bounds.volume(), regionHits<BALL4>},
+      {"ball5", ballVolume(5), BALL5.bounds.volume(), regionHits<BALL5>},
+      {"parabola", 4.0 / 3.0, PARABOLA.bounds.volume(), regionHits<PARABOLA>},
+      {"superellipse",
+       4.0 * std::tgamma(1.25) * std::tgamma(1.25) / std::tgamma(1.5),
+       SUPERELLIPSE.bounds.volume(), regionHits<SUPERELLIPSE>},
+  };
+  for (const Problem &p : problems)
+    if (strcmp(name, p.name) == 0)
+      return &p;
+  return nullptr;
+}
+
+// Runs a problem for the given budget and prints its JSON line
+static void runProblem(const Problem &p, uint64_t seed, uint64_t limit,
+                       double seconds, size_t batch) {
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point start = Clock::now();
+  uint64_t n = 0;
+  uint64_t hits = 0;
+  double elapsed = 0;
+  while (n < limit && (seconds <= 0 || elapsed < seconds)) {
+    size_t count = static_cast<size_t>(std::min<uint64_t>(batch, limit - n));
+    hits += p.hits(seed, n, count);
+    n += count;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  const double fraction = n ? static_cast<double>(hits) / n : 0.0;
+  const double estimate = p.volume * fraction;
+  // Binomial standard error of the hit fraction, scaled by the box
+  const double se = n ? p.volume * std::sqrt(fraction * (1 - fraction) / n) : 0;
+  printf("{\"problem\": \"%s\", \"threads\": 1, \"seed\": %llu, "
+         "\"samples\": %llu, \"seconds\": %.6f, \"samples_per_sec\": %.1f, "
+         "\"estimate\": %.12f, \"exact\": %.12f, \"error\": %.3e, "
+         "\"stderr\": %.3e}\n",
+         p.name, static_cast<unsigned long long>(seed),
+         static_cast<unsigned long long>(n), elapsed,
+         elapsed > 0 ? n / elapsed : 0.0, estimate, p.exact,
+         std::fabs(estimate - p.exact), se);
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [--samples n] [--seconds s] [--threads n] [--seed n] "
+          "[--batch n] [--mode name] [--checkpoint file]\n"
+          "       %s --problem disk|ball3|ball4|ball5|parabola|superellipse "
+          "[--samples n] [--seconds s] [--seed n] [--batch n]\n",
+          name, name);
+}
+
+int runBench(int argc, char *argv[]) {
+  double budget = 0;
+  double seconds = 0;
+  unsigned threads = 0;
+  size_t batch = 1 << 22;
+  const char *checkpoint = nullptr;
+  const Problem *problem = nullptr;
+  bool sampler_only = false; // An option --problem does not take was given
+  MonteCarlo mc;
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+      return -1;
+    }
+    const char *value = argv[++i];
+    if (strcmp(argv[i - 1], "--samples") == 0) {
+      budget = strtod(value, nullptr);
+    } else if (strcmp(argv[i - 1], "--seconds") == 0) {
+      seconds = strtod(value, nullptr);
+    } else if (strcmp(argv[i - 1], "--threads") == 0) {
+      threads = strtoul(value, nullptr, 0);
+      sampler_only = true;
+    } else if (strcmp(argv[i - 1], "--seed") == 0) {
+      mc.seed = strtoull(value, nullptr, 0);
+    } else if (strcmp(argv[i - 1], "--batch") == 0) {
+      batch = std::max<size_t>(1, strtoull(value, nullptr, 0));
+    } else if (strcmp(argv[i - 1], "--mode") == 0) {
+      mc.mode = sampleModeByName(value);
+      if (mc.mode == SAMPLE_MODES) {
+        usage(argv[0]);
+        return -1;
+      }
+      sampler_only = true;
+    } else if (strcmp(argv[i - 1], "--checkpoint") == 0) {
+      checkpoint = value;
+      sampler_only = true;
+    } else if (strcmp(argv[i - 1], "--problem") == 0) {
+      problem = findProblem(value);
+      if (!problem) {
+        usage(argv[0]);
+        return -1;
+      }
+    } else {
+      usage(argv[0]);
+      return -1;
+    }
+  }
+  if (problem && sampler_only) {
+    usage(argv[0]);
+    return -1;
+  }
+  if (budget <= 0 && seconds <= 0)
+    budget = 1e9;
+  const SampleGrid grid = {400, 400, 400 * 4, 4};
+  const uint64_t limit = budget > 0 ? static_cast<uint64_t>(budget) : UINT64_MAX;
+  if (problem) {
+    runProblem(*problem, mc.seed, limit, seconds, batch);
+    return 0;
+  }
+  mc.pool.start(threads, batch);
+  if (checkpoint)
+    loadCheckpoint(checkpoint, mc, nullptr);
+
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point start = Clock::now();
+  uint64_t submitted = 0;
+  double elapsed = 0;
+  while (submitted < limit && (seconds <= 0 || elapsed < seconds)) {
+    size_t count = static_cast<size_t>(std::min<uint64_t>(batch, limit - submitted));
+    mc.step(count, grid);
+    submitted += count;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  mc.step(0, grid);
+  elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  if (checkpoint && !saveCheckpoint(checkpoint, mc, nullptr))
+    fprintf(stderr, "Could not write checkpoint %s\n", checkpoint);
+
+  const double pi = static_cast<double>(mc.pi());
+  printf("{\"kernel\": \"%s\", \"mode\": \"%s\", \"threads\": %u, "
+         "\"seed\": %llu, \"samples\": %llu, \"seconds\": %.6f, "
+         "\"samples_per_sec\": %.1f, \"pi\": %.12f, \"error\": %.3e, "
+         "\"stderr\": %.3e, \"ci95\": %.3e}\n",
+         SAMPLER_KERNEL, SAMPLE_MODE_NAMES[mc.mode], mc.pool.workers(),
+         static_cast<unsigned long long>(mc.seed),
+         static_cast<unsigned long long>(mc.n), elapsed,
+         elapsed > 0 ? submitted / elapsed : 0.0, pi, std::fabs(pi - M_PI),
+         mc.stderror(), mc.ci95());
+  mc.pool.stop();
+  return 0;
+}
@@ -0,0 +1,177 @@
+#include "checkpoint.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char CHECKPOINT_MAGIC[8] = {'M', 'C', 'P', 'C', 'K', 'P', 'T', '1'};
+static const uint32_t CHECKPOINT_VERSION = 1;
+
+static const uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+static const uint64_t FNV_PRIME = 0x100000001B3ull;
+
+static uint64_t fnv1a(const uint8_t *p, size_t len) {
+  uint64_t h = FNV_OFFSET;
+  for (size_t i = 0; i < len; i++)
+    h = (h ^ p[i]) * FNV_PRIME;
+  return h;
+}
+
+// Little endian encoder, independent of the host byte order
+struct Writer {
+  std::vector<uint8_t> buf;
+
+  void u32(uint32_t v) {
+    for (int i = 0; i < 4; i++)
+      buf.push_back(static_cast<uint8_t>(v >> (8 * i)));
+  }
+  void u64(uint64_t v) {
+    for (int i = 0; i < 8; i++)
+      buf.push_back(static_cast<uint8_t>(v >> (8 * i)));
+  }
+  void f64(double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    u64(bits);
+  }
+};
+
+// Decoder for Writer, reads past the end set ok to false and return 0
+struct Reader {
+  const uint8_t *p;
+  const uint8_t *end;
+  bool ok = true;
+
+  bool need(size_t n) {
+    if (static_cast<size_t>(end - p) < n)
+      ok = false;
+    return ok;
+  }
+  uint32_t u32() {
+    uint32_t v = 0;
+    if (need(4))
+      for (int i = 0; i < 4; i++)
+        v |= static_cast<uint32_t>(*p++) << (8 * i);
+    return v;
+  }
+  uint64_t u64() {
+    uint64_t v = 0;
+    if (need(8))
+      for (int i = 0; i < 8; i++)
+        v |= static_cast<uint64_t>(*p++) << (8 * i);
+    return v;
+  }
+  double f64() {
+    uint64_t bits = u64();
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+};
+
+bool saveCheckpoint(const char *path, const MonteCarlo &mc,
+                    const HitCounts *hits) {
+  Writer out;
+  const bool with_hits = hits && !hits->counts.empty();
+  out.buf.assign(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC + sizeof(CHECKPOINT_MAGIC));
+  out.u32(CHECKPOINT_VERSION);
+  out.u32(with_hits ? CHECKPOINT_HITS : 0);
+  out.u64(mc.seed);
+  out.u64(mc.mode);
+  out.u64(mc.n);
+  out.u64(mc.p_count);
+  out.u64(mc.replicates);
+  out.u64(mc.open_inside);
+  out.f64(mc.replicate_mean);
+  out.f64(mc.replicate_m2);
+  if (with_hits) {
+    out.u32(hits->w);
+    out.u32(hits->h);
+    out.u64(hits->total);
+    out.buf.reserve(out.buf.size() + 4 * hits->counts.size() + 8);
+    for (uint32_t c : hits->counts)
+      out.u32(c);
+  }
+  out.u64(fnv1a(out.buf.data(), out.buf.size()));
+
+  const std::string tmp = std::string(path) + ".tmp";
+  FILE *f = fopen(tmp.c_str(), "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(out.buf.data(), 1, out.buf.size(), f) == out.buf.size();
+  ok = fclose(f) == 0 && ok;
+  if (!ok || rename(tmp.c_str(), path) != 0) {
+    remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool loadCheckpoint(const char *path, MonteCarlo &mc, HitCounts *hits) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;
+  std::vector<uint8_t> buf;
+  uint8_t chunk[1 << 16];
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    buf.insert(buf.end(), chunk, chunk + got);
+  fclose(f);
+
+  const size_t header = sizeof(CHECKPOINT_MAGIC) + 8;
+  if (buf.size() < header + 8 ||
+      memcmp(buf.data(), CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0)
+    return false;
+  const size_t body = buf.size() - 8;
+  Reader in = {buf.data() + sizeof(CHECKPOINT_MAGIC), buf.data() + body};
+  Reader hash = {buf.data() + body, buf.data() + buf.size()};
+  if (hash.u64() != fnv1a(buf.data(), body))
+    return false;
+
+  const uint32_t version = in.u32();
+  const uint32_t flags = in.u32();
+  const uint64_t seed = in.u64();
+  const uint64_t mode = in.u64();
+  const uint64_t n = in.u64();
+  const uint64_t p_count = in.u64();
+  const uint64_t replicates = in.u64();
+  const uint64_t open_inside = in.u64();
+  const double mean = in.f64();
+  const double m2 = in.f64();
+  if (!in.ok || version != CHECKPOINT_VERSION || mode >= SAMPLE_MODES ||
+      p_count > n)
+    return false;
+
+  // Only take the hit counts if they fit the grid of the caller
+  const uint8_t *counts = nullptr;
+  uint64_t total = 0;
+  if (flags & CHECKPOINT_HITS) {
+    const uint32_t w = in.u32();
+    const uint32_t h = in.u32();
+    total = in.u64();
+    const size_t bytes = 8 * static_cast<size_t>(w) * h;
+    if (!in.need(bytes))
+      return false;
+    if (hits && w == hits->w && h == hits->h)
+      counts = in.p;
+  }
+
+  mc.reset(seed);
+  mc.mode = static_cast<SampleMode>(mode);
+  mc.n = n;
+  mc.p_count = p_count;
+  mc.replicates = replicates;
+  mc.open_inside = open_inside;
+  mc.replicate_mean = mean;
+  mc.replicate_m2 = m2;
+  if (hits) {
+    hits->clear();
+    if (counts) {
+      Reader cells = {counts, counts + 4 * hits->counts.size()};
+      for (uint32_t &c : hits->counts)
+        c = cells.u32();
+      hits->total = total;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,48 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "hit_counts.h"
+#include "montecarlo.h"
+
+/*
+ * Binary checkpoint of a run, so long simulations survive restarts.
+ *
+ * The sampler is counter based, so the whole random state is the seed, the
+ * mode and the stream position n: a resumed run continues with exactly the
+ * samples it would have drawn. Next to that the file holds the counters and
+ * the replicate statistics, and optionally the per pixel hit counts so the
+ * plot comes back as well.
+ *
+ * Layout, all fields little endian:
+ *
+ *   char     magic[8]  "MCPCKPT1"
+ *   uint32   version, flags (CHECKPOINT_HITS)
+ *   uint64   seed, mode, n, p_count
+ *   uint64   replicates, open_inside
+ *   float64  replicate_mean, replicate_m2
+ *   [uint32  w, h; uint64 total; uint32 counts[2*w*h]]  if CHECKPOINT_HITS
+ *   uint64   FNV-1a hash of everything above
+ *
+ * The file is written next to its final path and renamed over it, so a crash
+ * while saving leaves the previous checkpoint intact.
+ */
+
+// Set in the flags when the file carries the hit counts
+const uint32_t CHECKPOINT_HITS = 1;
+
+/* saveCheckpoint(path, mc, hits) -> success
+ * Writes the state of mc, and of hits unless it is null, to path. Only the
+ * collected samples are recorded, a block still in flight is generated again
+ * after a resume.
+ */
+bool saveCheckpoint(const char *path, const MonteCarlo &mc,
+                    const HitCounts *hits);
+
+/* loadCheckpoint(path, mc, hits) -> success
+ * Restores mc from path and the hit counts into hits if both the file and
+ * hits have them and the grid sizes match, otherwise hits is cleared. On
+ * failure (no file, bad magic, version or hash) nothing is changed.
+ */
+bool loadCheckpoint(const char *path, MonteCarlo &mc, HitCounts *hits);
+
+#endif
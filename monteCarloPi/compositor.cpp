@@ -0,0 +1,64 @@
+#include "compositor.h"
+#include <cstdio>
+
+void Compositor::init(SDL_Renderer *renderer, const SDL_Color &background) {
+  destroy();
+  this->renderer = renderer;
+  this->background = background;
+  premultiplied = SDL_ComposeCustomBlendMode(
+      SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+      SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE,
+      SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+}
+
+void Compositor::destroy() {
+  for (Layer &l : layers)
+    if (l.draw)
+      SDL_DestroyTexture(l.texture);
+  layers.clear();
+}
+
+int Compositor::addLayer(const SDL_Rect &rect, LayerDraw draw) {
+  SDL_Texture *texture =
+      SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                        SDL_TEXTUREACCESS_TARGET, rect.w, rect.h);
+  if (!texture) {
+    printf("Layer texture could not be created! SDL Error: %s\n",
+           SDL_GetError());
+    return -1;
+  }
+  if (SDL_SetTextureBlendMode(texture, premultiplied) < 0)
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  layers.push_back({rect, texture, draw, true, true});
+  return static_cast<int>(layers.size()) - 1;
+}
+
+int Compositor::addTexture(const SDL_Rect &rect, SDL_Texture *texture) {
+  layers.push_back({rect, texture, nullptr, false, true});
+  return static_cast<int>(layers.size()) - 1;
+}
+
+void Compositor::invalidateAll() {
+  for (Layer &l : layers)
+    l.dirty = l.draw != nullptr;
+}
+
+void Compositor::compose() {
+  for (Layer &l : layers) {
+    // Hidden layers keep their dirty flag until they are shown
+    if (!l.dirty || !l.visible)
+      continue;
+    SDL_SetRenderTarget(renderer, l.texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    l.draw(renderer);
+    l.dirty = false;
+  }
+  SDL_SetRenderTarget(renderer, nullptr);
+  SDL_SetRenderDrawColor(renderer, background.r, background.g, background.b,
+                         background.a);
+  SDL_RenderClear(renderer);
+  for (const Layer &l : layers)
+    if (l.visible)
+      SDL_RenderCopy(renderer, l.texture, nullptr, &l.rect);
+}
@@ -0,0 +1,61 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <SDL.h>
+#include <vector>
+
+/*
+ * Retained layers composed on the GPU. Every layer keeps its content in a
+ * texture: either its own render target, redrawn by its callback only after
+ * invalidate(), or an external texture its owner updates (the streaming
+ * plot). compose() redraws the dirty layers and copies the visible ones over
+ * a cleared screen in the order they were added, so a frame without changes
+ * costs a few texture copies and nothing is ever read back from the GPU.
+ *
+ * Render targets start out transparent black and hold premultiplied alpha,
+ * they are composed with a premultiplied blend mode where the renderer has
+ * one. Without it plain blending is used, which is still exact for the black
+ * text drawn here.
+ */
+
+// Draws a layer, the origin of the renderer is the top left of the layer
+typedef void (*LayerDraw)(SDL_Renderer *renderer);
+
+class Compositor {
+public:
+  // Layers are added after init(), background is the clear color
+  void init(SDL_Renderer *renderer, const SDL_Color &background);
+  void destroy();
+
+  /* addLayer(rect, draw) -> layer
+   * Adds a layer with its own render target of rect's size, drawn by draw.
+   * Returns -1 if the target could not be created.
+   */
+  int addLayer(const SDL_Rect &rect, LayerDraw draw);
+  // Adds a layer showing texture at rect, its content is not managed here
+  int addTexture(const SDL_Rect &rect, SDL_Texture *texture);
+
+  // Marks a layer for redrawing at the next compose()
+  void invalidate(int layer) { layers[layer].dirty = true; }
+  // Redraws every layer, after the renderer lost its targets
+  void invalidateAll();
+  void show(int layer, bool visible) { layers[layer].visible = visible; }
+
+  // Redraws the dirty layers and composes the visible ones on the screen
+  void compose();
+
+private:
+  struct Layer {
+    SDL_Rect rect;
+    SDL_Texture *texture;
+    LayerDraw draw; // nullptr for external textures
+    bool dirty;
+    bool visible;
+  };
+  SDL_Renderer *renderer = nullptr;
+  SDL_Color background = {255, 255, 255, 255};
+  SDL_BlendMode premultiplied = SDL_BLENDMODE_BLEND;
+  std::vector<Layer> layers;
+};
+
+#endif
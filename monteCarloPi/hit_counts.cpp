@@ -0,0 +1,22 @@
+#include "hit_counts.h"
+#include <algorithm>
+
+void HitCounts::resize(uint32_t w, uint32_t h) {
+  this->w = w;
+  this->h = h;
+  counts.assign(2 * static_cast<size_t>(w) * h, 0);
+  total = 0;
+}
+
+void HitCounts::clear() {
+  std::fill(counts.begin(), counts.end(), 0);
+  total = 0;
+}
+
+void HitCounts::add(const std::vector<uint32_t> &samples) {
+  uint32_t *c = counts.data();
+  // Slot 0 of a cell counts inside samples, slot 1 outside ones
+  for (uint32_t s : samples)
+    c[2 * (s & SAMPLE_INDEX) + (~s >> 31)]++;
+  total += samples.size();
+}
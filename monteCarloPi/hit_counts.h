@@ -0,0 +1,27 @@
+#ifndef HIT_COUNTS_H
+#define HIT_COUNTS_H
+
+#include "sampler.h"
+#include <cstdint>
+#include <vector>
+
+/*
+ * Per pixel accumulation buffer. Samples are generated on grid(), where a
+ * sample word is the cell index, and add() turns each one into a single
+ * counter increment. Colour is left to a resolve pass over the counts.
+ */
+struct HitCounts {
+  uint32_t w = 0;
+  uint32_t h = 0;
+  std::vector<uint32_t> counts; // Two per cell: inside, outside
+  uint64_t total = 0;           // Samples added since clear()
+
+  void resize(uint32_t w, uint32_t h);
+  void clear();
+  void add(const std::vector<uint32_t> &samples);
+  SampleGrid grid() const { return {w, h, w, 1}; }
+  uint32_t inside(uint32_t cell) const { return counts[2 * cell]; }
+  uint32_t outside(uint32_t cell) const { return counts[2 * cell + 1]; }
+};
+
+#endif
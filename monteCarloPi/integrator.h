@@ -0,0 +1,233 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include "sampler.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Hit or miss Monte Carlo integration over a region that is known at compile
+ * time. integrate<Region>() draws uniform points in the bounding box of the
+ * region and counts the ones inside, the estimate is the box volume times
+ * the hit fraction. Region is a template parameter, so every problem compiles
+ * to its own kernel with the membership test inlined into the sampling loop:
+ * no virtual calls, and the compiler is free to vectorize across samples.
+ *
+ * A region looks like this:
+ *
+ *   struct Region {
+ *     static const int DIM = 3;       // Dimensions of the sample space
+ *     Bounds<DIM> bounds;             // Box the points are drawn from
+ *     bool operator()(const float *x) const; // x[DIM] is inside
+ *   };
+ *
+ * Coordinates come from the same Philox stream as the Pi sampler: sample i
+ * uses the words i*DIM .. i*DIM + DIM - 1, where word k is word k % 4 of the
+ * Philox block k / 4. Each word gives a 24-bit fraction u, mapped into the box
+ * as lo + (hi - lo) * u. For UnitBall<2> this is exactly the Pi sampler:
+ * sampleBatch() runs integrate<UnitBall<2>> as its portable path, and the
+ * hand written SIMD kernels give the same samples.
+ *
+ * Optionally the first two coordinates are plotted on a SampleGrid, then a
+ * sample word is written per sample like sampleBatch() does.
+ *
+ * Translation units that use this must be built with -ffp-contract=off like
+ * mcp_core, or lo + span * u may be fused and round differently.
+ */
+
+template <int Dim> struct Bounds {
+  float lo[Dim];
+  float hi[Dim];
+
+  double volume() const {
+    double v = 1.0;
+    for (int d = 0; d < Dim; d++)
+      v *= static_cast<double>(hi[d]) - lo[d];
+    return v;
+  }
+};
+
+// Unit n-ball in [-1,1]^Dim, UnitBall<2> is the Pi estimator
+template <int Dim> struct UnitBall {
+  static const int DIM = Dim;
+  Bounds<Dim> bounds;
+
+  UnitBall() {
+    std::fill(bounds.lo, bounds.lo + Dim, -1.0F);
+    std::fill(bounds.hi, bounds.hi + Dim, 1.0F);
+  }
+  bool operator()(const float *x) const {
+    float r2 = 0.0F;
+    for (int d = 0; d < Dim; d++)
+      r2 += x[d] * x[d];
+    return r2 <= 1.0F;
+  }
+};
+
+// Area between the x axis and f on [x0,x1], for 0 <= f(x) <= y_max
+template <class F> struct UnderGraph {
+  static const int DIM = 2;
+  Bounds<2> bounds;
+  F f;
+
+  UnderGraph(F f, float x0, float x1, float y_max)
+      : bounds{{x0, 0.0F}, {x1, y_max}}, f(f) {}
+  bool operator()(const float *x) const { return x[1] <= f(x[0]); }
+};
+
+// Region given by a predicate, e.g. an implicit curve g(x) <= 0 or a polygon
+template <int Dim, class Inside> struct Implicit {
+  static const int DIM = Dim;
+  Bounds<Dim> bounds;
+  Inside inside;
+
+  Implicit(const Bounds<Dim> &bounds, Inside inside)
+      : bounds(bounds), inside(inside) {}
+  bool operator()(const float *x) const { return inside(x); }
+};
+
+// Philox4x32-10 on N consecutive blocks at once, w[4 * b + j] is word j of
+// block b, so w is the word stream from block on. The blocks are independent,
+// so the loops vectorize.
+template <size_t N>
+inline void philoxBlocks(uint64_t block, uint64_t seed, uint32_t (&w)[4 * N]) {
+  uint32_t c0[N], c1[N], c2[N], c3[N];
+  for (size_t b = 0; b < N; b++) {
+    c0[b] = static_cast<uint32_t>(block + b);
+    c1[b] = static_cast<uint32_t>((block + b) >> 32);
+    c2[b] = 0;
+    c3[b] = 0;
+  }
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+  for (int r = 0; r < PHILOX_ROUNDS; r++) {
+    for (size_t b = 0; b < N; b++) {
+      uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0[b];
+      uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2[b];
+      uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[b] ^ k0;
+      uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[b] ^ k1;
+      c1[b] = static_cast<uint32_t>(p1);
+      c3[b] = static_cast<uint32_t>(p0);
+      c0[b] = n0;
+      c2[b] = n2;
+    }
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  for (size_t b = 0; b < N; b++) {
+    w[4 * b] = c0[b];
+    w[4 * b + 1] = c1[b];
+    w[4 * b + 2] = c2[b];
+    w[4 * b + 3] = c3[b];
+  }
+}
+
+// Sample word of the point u in [0,1)^DIM, plotted on g if Plot is set
+template <bool Plot, class Region>
+inline uint32_t regionSample(const Region &r, const float *u,
+                             const SampleGrid &g) {
+  float x[Region::DIM];
+  for (int d = 0; d < Region::DIM; d++)
+    x[d] = r.bounds.lo[d] + (r.bounds.hi[d] - r.bounds.lo[d]) * u[d];
+  uint32_t s = r(x) ? SAMPLE_INSIDE : 0;
+  if (Plot) {
+    float v = Region::DIM > 1 ? u[1] : 0.0F;
+    uint32_t gridX = static_cast<uint32_t>(
+        std::min(u[0] * static_cast<float>(g.w), static_cast<float>(g.w - 1)));
+    uint32_t gridY = static_cast<uint32_t>(
+        std::min(v * static_cast<float>(g.h), static_cast<float>(g.h - 1)));
+    s |= gridY * g.pitch + gridX * g.bytes;
+  }
+  return s;
+}
+
+// One sample on its own, for the unaligned head and the tail of a batch
+template <bool Plot, class Region>
+inline uint32_t regionSampleAt(const Region &r, uint64_t seed, uint64_t i,
+                               const SampleGrid &g) {
+  float u[Region::DIM];
+  uint32_t w[4];
+  uint64_t block = ~0ull;
+  for (int d = 0; d < Region::DIM; d++) {
+    uint64_t k = i * Region::DIM + d;
+    if (k >> 2 != block) {
+      block = k >> 2;
+      uint32_t ctr[4] = {static_cast<uint32_t>(block),
+                         static_cast<uint32_t>(block >> 32), 0, 0};
+      philox4x32(ctr, seed, w);
+    }
+    u[d] = static_cast<float>(w[k & 3] >> 8) * SAMPLE_UNIT;
+  }
+  return regionSample<Plot>(r, u, g);
+}
+
+// Kernel of integrate(), Plot selects whether sample words are written
+template <bool Plot, class Region>
+uint64_t integrateRange(const Region &r, uint64_t seed, uint64_t first,
+                        size_t count, SampleGrid g, uint32_t *out) {
+  const int D = Region::DIM;
+  // STEP samples per round take BLOCKS whole Philox blocks. 64 samples keep
+  // the unrolled rounds in registers and vectorize well for small DIM.
+  const size_t STEP = 64;
+  const size_t BLOCKS = STEP * D / 4;
+  uint64_t hits = 0;
+  uint64_t i = first;
+  const uint64_t end = first + count;
+  for (; i < end && i % 4; i++) {
+    uint32_t s = regionSampleAt<Plot>(r, seed, i, g);
+    hits += s >> 31;
+    if (Plot)
+      *out++ = s;
+  }
+  for (; end - i >= STEP; i += STEP) {
+    uint32_t w[4 * BLOCKS];
+    philoxBlocks<BLOCKS>(i * D / 4, seed, w);
+    float u[D][STEP];
+    for (size_t s = 0; s < STEP; s++)
+      for (int d = 0; d < D; d++)
+        u[d][s] = static_cast<float>(w[s * D + d] >> 8) * SAMPLE_UNIT;
+    uint32_t inside = 0;
+    for (size_t s = 0; s < STEP; s++) {
+      float x[D];
+      for (int d = 0; d < D; d++)
+        x[d] = u[d][s];
+      uint32_t word = regionSample<Plot>(r, x, g);
+      inside += word >> 31;
+      if (Plot)
+        out[s] = word;
+    }
+    hits += inside;
+    if (Plot)
+      out += STEP;
+  }
+  for (; i < end; i++) {
+    uint32_t s = regionSampleAt<Plot>(r, seed, i, g);
+    hits += s >> 31;
+    if (Plot)
+      *out++ = s;
+  }
+  return hits;
+}
+
+/* integrate(region, seed, first, count, grid, out) -> hits
+ * Draws samples first .. first + count - 1 of the stream given by seed and
+ * returns how many fall inside region. With a grid, one sample word per
+ * sample is written to out.
+ */
+template <class Region>
+uint64_t integrate(const Region &r, uint64_t seed, uint64_t first,
+                   size_t count, const SampleGrid *grid = nullptr,
+                   uint32_t *out = nullptr) {
+  if (grid && out)
+    return integrateRange<true>(r, seed, first, count, *grid, out);
+  return integrateRange<false>(r, seed, first, count, SampleGrid(), nullptr);
+}
+
+// Box volume times the hit fraction
+template <class Region>
+double integralEstimate(const Region &r, uint64_t hits, uint64_t n) {
+  return n ? r.bounds.volume() * static_cast<double>(hits) / n : 0.0;
+}
+
+#endif
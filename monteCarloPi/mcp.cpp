@@ -10,183 +10,380 @@
 #include "SDL_surface.h"
 #include "SDL_timer.h"
 #include "SDL_video.h"
+#include "checkpoint.h"
+#include "compositor.h"
+#include "hit_counts.h"
+#include "montecarlo.h"
+#include "profiler.h"
+#include "text.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
-#include <climits>
-#include <cmath>
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <list>
-#include <random>
 #include <stdio.h>
 
 // Constants
-int HEIGHT = 480;
+int HEIGHT = 500;
 int WIDTH = 400;
+// Initial capacity of the sample buffers, they only grow past this if a single
+// step asks for more samples.
+const size_t SAMPLE_CAPACITY = 1 << 16;
+// The plot is resolved and uploaded in bands of rows, only bands that received
+// samples since the last frame are redone. Batches this large touch every band
+// anyway, so they skip the per sample bookkeeping.
+const int DIRTY_BAND_ROWS = 16;
+const size_t DIRTY_ALL_SAMPLES = 4096;
+const uint64_t DIRTY_ALL = ~0ULL;
+// Frame pacing: sampling and drawing get FRAME_BUDGET_MS of each FRAME_MS
+// vsync interval, a frame slower than FRAME_LATE_MS halves the next batch.
+const double FRAME_MS = 1000.0 / 60.0;
+const double FRAME_BUDGET_MS = 12.0;
+const double FRAME_LATE_MS = 1.5 * FRAME_MS;
+const double COST_SMOOTHING = 0.25; // Weight of the newest cost measurement
+const long MAX_BATCH = 1L << 26;
+// The run is checkpointed this often and on quit, and resumed on startup.
+// Under Emscripten the file lives on IndexedDB (IDBFS) so it survives reloads.
+const Uint32 CHECKPOINT_INTERVAL_MS = 30000;
+#ifdef __EMSCRIPTEN__
+const char *const CHECKPOINT_DIR = "/persist";
+const char *const CHECKPOINT_FILE = "/persist/mcp.ckpt";
+#else
+const char *const CHECKPOINT_FILE = "mcp.ckpt";
+#endif
+// Written by the T key while the profiler is on
+const char *const TRACE_FILE = "mcp_trace.json";
+
+/*
+ * Sizes the sample batch of each frame from the measured cost of sampling
+ * and drawing, so one batch fills the frame budget on any machine. Exactly one
+ * batch runs per frame, a slow frame shrinks the next one instead of queueing
+ * up more work.
+ */
+struct Scheduler {
+  long batch = 1;           // Samples to start in the coming frame
+  double ns_per_sample = 0; // Smoothed cost of one sample
+  Uint64 frame_start = 0;   // Performance counter at the last frame start
+
+  // Starts timing anew, after pause and reset
+  void restart() { frame_start = SDL_GetPerformanceCounter(); }
+  // Marks the start of a frame, returns the time since the previous one
+  double beginFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    double ms = toMs(now - frame_start);
+    frame_start = now;
+    return ms;
+  }
+  // Feeds back the work of a frame, samples were drawn in work_ms
+  void update(long samples, double work_ms, double frame_ms) {
+    if (samples > 0 && work_ms > 0) {
+      double cost = work_ms * 1e6 / samples;
+      if (ns_per_sample == 0)
+        ns_per_sample = cost;
+      else
+        ns_per_sample += COST_SMOOTHING * (cost - ns_per_sample);
+    }
+    if (frame_ms > FRAME_LATE_MS) {
+      batch = std::max(1L, batch / 2);
+      return;
+    }
+    long target = batch * 2;
+    if (ns_per_sample > 0)
+      target = static_cast<long>(FRAME_BUDGET_MS * 1e6 / ns_per_sample);
+    // Grow at most 2x per frame so a cheap measurement can not overshoot
+    batch = std::clamp(target, 1L, std::min(batch * 2, MAX_BATCH));
+  }
+  static double toMs(Uint64 ticks) {
+    return ticks * 1000.0 / SDL_GetPerformanceFrequency();
+  }
+};
 
 // Container for Pi Approximation
-struct MonteCarlo {
-  long n = 0;
-  long p_count = 0;
-  std::mt19937 m_generator{std::random_device{}()};
-  std::uniform_real_distribution<double> m_dist{0.0F, 1.0F};
-  std::pair<double, double> randXY() {
-    return std::pair<double, double>(
-        {m_dist(m_generator), m_dist(m_generator)});
-  };
-} MonteCarlo;
+struct MonteCarlo MonteCarlo;
 
 // Container for SDL assets
 struct Assets {
   SDL_Window *window;
   SDL_Surface *surface;
-  SDL_Surface *surface_bg;
   SDL_Renderer *renderer;
-  SDL_Texture *screenTexture;
-  SDL_Texture *backgroundTexture;
+  SDL_Texture *screenTexture; // Streaming copy of surface
+  uint64_t dirty_bands = 0; // Bit i: rows [i, i+1) * DIRTY_BAND_ROWS changed
+  HitCounts hits;           // Samples per pixel, resolved into surface
+  uint32_t knee = 1;        // Tone map knee, see resolvePixels
   SDL_Rect dstrect = {0, 0, 400, 400};
   SDL_Rect dstrect_bar = {410, 0, 100, 400};
+  SDL_Rect textrect = {0, 400, 400, 100}; // Labels and numbers below the plot
   SDL_Color textColor = {0, 0, 0, 255};
   SDL_Colour red = {255, 0, 0, 255};
   SDL_Colour blue = {0, 0, 255, 255};
-  Uint64 runtime = 0;
-  uint64_t prev_len = 0;
-  const double time_delta = 0.01F;
-  double time = 0.0F;
-  double time_acc = 0;
+  Scheduler schedule;
+  Profiler profile; // F3 toggles it together with its overlay
   TTF_Font *font;
   TTF_Font *font_large;
+  GlyphAtlas glyphs; // font, for the numbers that change every frame
+  TextLabel label_pi;
+  TextLabel label_n;
+  TextLabel label_inside;
+  TextLabel label_ci;
+  TextLabel label_pause; // font_large
+  // Layers of the window, bottom to top, see initLayers
+  Compositor layers;
+  int layer_plot = -1;
+  int layer_text = -1;
+  int layer_frame = -1;
+  int layer_profile = -1;
+  int layer_pause = -1;
+  char text[4][32] = {}; // The numbers shown in layer_text
+  const char *checkpoint = CHECKPOINT_FILE; // nullptr: no checkpoints
+  Uint32 last_checkpoint = 0;               // SDL_GetTicks of the last save
   bool quit = false;
   bool pause = false;
-  long random_pixels = 1;
 } Assets;
 
-/* getRandomPixels(const long &num_samples) -> std::list<std::pair<uint32_t,
- * bool>> Returns a list of pairs <pixel-index, true/false> where true/false
- * reflects the pixels position inside the unit circle. Also updates the
- * MonteCarlo values for Approximation.
+/* getRandomPixels(const long &num_samples) -> const SampleBlock &
+ * Returns the block of samples started by the previous call and starts
+ * num_samples new ones on the worker pool, so the returned block can be drawn
+ * while the next one is generated. Each sample word is a cell of Assets.hits,
+ * with SAMPLE_INSIDE set when the pixel is inside the unit circle. Also updates
+ * the MonteCarlo values for Approximation with the returned block.
  */
-static std::list<std::pair<uint32_t, bool>>
-getRandomPixels(const long &num_samples) {
-  std::list<std::pair<uint32_t, bool>> pixel_list;
-  if (!Assets.surface)
-    return pixel_list;
-  if (num_samples < 1) {
-    return pixel_list;
-  }
-  const uint32_t w = Assets.surface->w;
-  const uint32_t h = Assets.surface->h;
-  const uint32_t pitch = Assets.surface->pitch;
-  const uint32_t bytes = Assets.surface->format->BytesPerPixel;
-  int i = 0;
-  while (i++ < num_samples) {
-    auto [x, y] = MonteCarlo.randXY();
-    // Convert [0.0,1.0] to [-1.0,1.0]
-    x = 2 * x - 1.0F;
-    y = 2 * y - 1.0F;
-    bool inside = false;
-    if (x * x + y * y <= 1.0F) {
-      MonteCarlo.p_count++;
-      inside = true;
-    }
-    uint32_t gridX = (uint32_t)(((x + 1.0F) / 2.0F) * w);
-    uint32_t gridY = (uint32_t)(((y + 1.0F) / 2.0F) * h);
-    gridX = std::clamp(gridX, static_cast<uint32_t>(0), w - 1);
-    gridY = std::clamp(gridY, static_cast<uint32_t>(0), h - 1);
-    uint32_t pixel_index = (gridY * pitch) + gridX * bytes;
-    pixel_list.push_back({pixel_index, inside});
+static const SampleBlock &getRandomPixels(const long &num_samples) {
+  PROFILE_SCOPE(Assets.profile, PHASE_SAMPLE);
+  if (Assets.hits.counts.empty() || num_samples < 1)
+    return MonteCarlo.step(0, SampleGrid());
+  return MonteCarlo.step(num_samples, Assets.hits.grid());
+}
+
+/*
+ * Adds a buffer of sample words to the hit counts, one increment per sample,
+ * and marks the bands that received samples for resolvePixels.
+ */
+static void accumulatePixels(const std::vector<uint32_t> &ps) {
+  PROFILE_SCOPE(Assets.profile, PHASE_ACCUMULATE);
+  Assets.hits.add(ps);
+  if (ps.size() >= DIRTY_ALL_SAMPLES) {
+    Assets.dirty_bands = DIRTY_ALL;
+  } else {
+    const uint32_t band_cells = Assets.hits.w * DIRTY_BAND_ROWS;
+    for (uint32_t s : ps)
+      Assets.dirty_bands |= 1ULL << ((s & SAMPLE_INDEX) / band_cells);
   }
-  MonteCarlo.n += num_samples;
-  return pixel_list;
 }
 
 /*
- * Takes a list of pairs (pixel-index, true/false), color for inside and color
- * for outside. If pixel is true, color for inside is used. If pixer is false,
- * color for outside is used.
+ * Tone maps the hit counts of the dirty bands into the surface, once per
+ * frame. A pixel gets the mix of color for inside and color for outside given
+ * by its counts, at a strength of t / (t + knee) for t hits. The knee follows
+ * half the mean hits per pixel, rounded down to a power of two so bands without
+ * new samples keep their colors until it moves.
  */
-static void drawPixels(const std::list<std::pair<uint32_t, bool>> &ps,
-                       const SDL_Colour &in, const SDL_Colour &out) {
-  //
+static void resolvePixels(const SDL_Colour &in, const SDL_Colour &out) {
+  PROFILE_SCOPE(Assets.profile, PHASE_RESOLVE);
+  const HitCounts &hits = Assets.hits;
+  uint64_t mean = hits.total / (static_cast<uint64_t>(hits.w) * hits.h);
+  uint32_t knee = 1;
+  while (knee <= mean / 4)
+    knee <<= 1;
+  if (knee != Assets.knee) {
+    Assets.knee = knee;
+    Assets.dirty_bands = DIRTY_ALL;
+  }
+  if (!Assets.dirty_bands)
+    return;
+
   if (SDL_MUSTLOCK(Assets.surface)) {
     SDL_LockSurface(Assets.surface);
   }
-  Uint8 *pixels = static_cast<Uint8 *>(Assets.surface->pixels);
-  for (auto [p, inside] : ps) {
-    if (inside) {
-      pixels[p] = in.r;
-      pixels[p + 1] = in.g;
-      pixels[p + 2] = in.b;
-      pixels[p + 3] = in.a;
-    } else {
-      pixels[p] = out.r;
-      pixels[p + 1] = out.g;
-      pixels[p + 2] = out.b;
-      pixels[p + 3] = out.a;
+  const SDL_PixelFormat *f = Assets.surface->format;
+  const int bands = (hits.h + DIRTY_BAND_ROWS - 1) / DIRTY_BAND_ROWS;
+  for (int band = 0; band < bands; band++) {
+    if (!(Assets.dirty_bands >> band & 1))
+      continue;
+    uint32_t y_end = std::min<uint32_t>((band + 1) * DIRTY_BAND_ROWS, hits.h);
+    for (uint32_t y = band * DIRTY_BAND_ROWS; y < y_end; y++) {
+      Uint32 *row = reinterpret_cast<Uint32 *>(
+          static_cast<Uint8 *>(Assets.surface->pixels) +
+          y * Assets.surface->pitch);
+      const uint32_t *c = hits.counts.data() + 2 * y * hits.w;
+      for (uint32_t x = 0; x < hits.w; x++) {
+        float ci = static_cast<float>(c[2 * x]);
+        float co = static_cast<float>(c[2 * x + 1]);
+        float t = ci + co;
+        float inv = 1.0F / (t + knee);
+        // 255 - strength * (255 - mix), with the mix weighted by the counts
+        Uint32 r = static_cast<Uint32>(
+            255.0F - (255.0F * t - (ci * in.r + co * out.r)) * inv);
+        Uint32 g = static_cast<Uint32>(
+            255.0F - (255.0F * t - (ci * in.g + co * out.g)) * inv);
+        Uint32 b = static_cast<Uint32>(
+            255.0F - (255.0F * t - (ci * in.b + co * out.b)) * inv);
+        row[x] = (r << f->Rshift) | (g << f->Gshift) | (b << f->Bshift) |
+                 f->Amask;
+      }
     }
   }
   if (SDL_MUSTLOCK(Assets.surface)) {
     SDL_UnlockSurface(Assets.surface);
   }
-  if (Assets.screenTexture)
-    SDL_DestroyTexture(Assets.screenTexture);
-  Assets.screenTexture =
-      SDL_CreateTextureFromSurface(Assets.renderer, Assets.surface);
-  if (!Assets.screenTexture) {
-    printf("Error creating screenTexture: %s\n", SDL_GetError());
-    exit(-1);
+}
+
+/*
+ * Uploads the dirty bands of the surface to the streaming screenTexture. Runs
+ * at most once per presented frame, after resolvePixels.
+ */
+static void uploadPixels() {
+  PROFILE_SCOPE(Assets.profile, PHASE_UPLOAD);
+  const int h = Assets.surface->h;
+  const int pitch = Assets.surface->pitch;
+  const Uint8 *pixels = static_cast<const Uint8 *>(Assets.surface->pixels);
+  const int bands = (h + DIRTY_BAND_ROWS - 1) / DIRTY_BAND_ROWS;
+  int band = 0;
+  while (band < bands) {
+    if (!(Assets.dirty_bands >> band & 1)) {
+      band++;
+      continue;
+    }
+    // Send each run of dirty bands as one rectangle
+    int end = band;
+    while (end < bands && Assets.dirty_bands >> end & 1)
+      end++;
+    int y = band * DIRTY_BAND_ROWS;
+    int rows = std::min(end * DIRTY_BAND_ROWS, h) - y;
+    SDL_Rect rect = {0, y, Assets.surface->w, rows};
+    if (SDL_UpdateTexture(Assets.screenTexture, &rect, pixels + y * pitch,
+                          pitch) < 0) {
+      printf("Error updating screenTexture: %s\n", SDL_GetError());
+      exit(-1);
+    }
+    band = end;
+  }
+  Assets.dirty_bands = 0;
+}
+
+/*
+ * Formats the numbers shown next to the labels, the text layer is only redrawn
+ * when one of them changed.
+ */
+static void updateText() {
+  PROFILE_SCOPE(Assets.profile, PHASE_TEXT);
+  char txt[4][32];
+  std::snprintf(txt[0], sizeof(txt[0]), "%.10Lf", MonteCarlo.pi());
+  std::snprintf(txt[1], sizeof(txt[1]), "%llu",
+                static_cast<unsigned long long>(MonteCarlo.n));
+  std::snprintf(txt[2], sizeof(txt[2]), "%llu",
+                static_cast<unsigned long long>(MonteCarlo.p_count));
+  std::snprintf(txt[3], sizeof(txt[3]), "%.3e (%s)", MonteCarlo.ci95(),
+                SAMPLE_MODE_NAMES[MonteCarlo.mode]);
+  if (memcmp(txt, Assets.text, sizeof(txt)) != 0) {
+    memcpy(Assets.text, txt, sizeof(txt));
+    Assets.layers.invalidate(Assets.layer_text);
+  }
+}
+
+// Layer below the plot with the numbers related to the Approximation of Pi.
+// The labels are cached textures, the numbers come from the glyph atlas.
+static void drawText(SDL_Renderer *renderer) {
+  const TextLabel *labels[4] = {&Assets.label_pi, &Assets.label_n,
+                                &Assets.label_inside, &Assets.label_ci};
+  for (int i = 0; i < 4; i++) {
+    int x = labels[i]->draw(renderer, 10, 10 + 20 * i);
+    Assets.glyphs.draw(renderer, Assets.text[i], x, 10 + 20 * i,
+                       Assets.textColor);
   }
 }
 
-// Render text related to the Approximation of Pi
-static void drawText() {
-  long double pi = (4L * (long double)MonteCarlo.p_count) / MonteCarlo.n;
-  char txt[100];
-  std::snprintf(txt, sizeof(txt), "Approximation of Pi: %.10Lf", pi);
-
-  SDL_Surface *textSurface =
-      TTF_RenderText_Solid(Assets.font, txt, Assets.textColor);
-  SDL_Texture *textTexture =
-      SDL_CreateTextureFromSurface(Assets.renderer, textSurface);
-  SDL_Rect textRect = {10, 410, textSurface->w,
-                       textSurface->h}; // Position to the right
-  SDL_RenderCopy(Assets.renderer, textTexture, NULL, &textRect);
-  SDL_FreeSurface(textSurface);
-  SDL_DestroyTexture(textTexture);
-
-  std::snprintf(txt, sizeof(txt), "Random pixels: %ld", MonteCarlo.n);
-  textSurface = TTF_RenderText_Solid(Assets.font, txt, Assets.textColor);
-  textTexture = SDL_CreateTextureFromSurface(Assets.renderer, textSurface);
-  textRect = {10, 430, textSurface->w, textSurface->h}; // Position to the right
-  SDL_RenderCopy(Assets.renderer, textTexture, NULL, &textRect);
-  SDL_FreeSurface(textSurface);
-  SDL_DestroyTexture(textTexture);
-
-  std::snprintf(txt, sizeof(txt), "Random pixels with radii <= 1: %ld",
-                MonteCarlo.p_count);
-  textSurface = TTF_RenderText_Solid(Assets.font, txt, Assets.textColor);
-  textTexture = SDL_CreateTextureFromSurface(Assets.renderer, textSurface);
-  textRect = {10, 450, textSurface->w, textSurface->h}; // Position to the right
-  SDL_RenderCopy(Assets.renderer, textTexture, NULL, &textRect);
-
-  // Clean up text surfaces
-  SDL_FreeSurface(textSurface);
-  SDL_DestroyTexture(textTexture);
+// Border of the plot, drawn once
+static void drawFrame(SDL_Renderer *renderer) {
+  SDL_Rect border = {0, 0, Assets.dstrect.w, Assets.dstrect.h};
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+  SDL_RenderDrawRect(renderer, &border);
 }
 
-// Render text during the pause event
-static void drawPauseText() {
-  char txt[100];
-  std::snprintf(txt, sizeof(txt), "Paused. Right click to reset.");
-  SDL_Surface *ts =
-      TTF_RenderText_Solid(Assets.font_large, txt, Assets.textColor);
-  SDL_Texture *tt = SDL_CreateTextureFromSurface(Assets.renderer, ts);
-  SDL_Rect tr = {20, 200, ts->w, ts->h};
-  SDL_RenderCopy(Assets.renderer, tt, NULL, &tr);
-  SDL_FreeSurface(ts);
-  SDL_DestroyTexture(tt);
+// Profiler overlay in the top left corner of the plot, redrawn every frame
+static void drawProfile(SDL_Renderer *renderer) {
+  const Profiler &p = Assets.profile;
+  const int line = Assets.glyphs.height;
+  SDL_Rect box = {0, 0, 230, (PHASE_COUNT + 2) * line + 10};
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xC0);
+  SDL_RenderFillRect(renderer, &box);
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+  char txt[64];
+  int y = 5;
+  std::snprintf(txt, sizeof(txt), "frame p50 %.2f p99 %.2f ms", p.frameMs(50),
+                p.frameMs(99));
+  Assets.glyphs.draw(renderer, txt, 5, y, Assets.textColor);
+  y += line;
+  std::snprintf(txt, sizeof(txt), "%.3g samples/s", p.samplesPerSec());
+  Assets.glyphs.draw(renderer, txt, 5, y, Assets.textColor);
+  for (int phase = PHASE_FRAME + 1; phase < PHASE_COUNT; phase++) {
+    y += line;
+    std::snprintf(txt, sizeof(txt), "%-10s %6.3f ms", PHASE_NAMES[phase],
+                  p.phaseMs(static_cast<ProfilePhase>(phase)));
+    Assets.glyphs.draw(renderer, txt, 5, y, Assets.textColor);
+  }
+}
+
+// Writes the profiler events as a Chrome trace, the browser downloads it
+static void exportTrace() {
+  if (!Assets.profile.exportTrace(TRACE_FILE)) {
+    printf("Could not write %s\n", TRACE_FILE);
+    return;
+  }
+#ifdef __EMSCRIPTEN__
+  EM_ASM(
+      {
+        var name = UTF8ToString($0);
+        var blob = new Blob([FS.readFile(name)], {type : 'application/json'});
+        var a = document.createElement('a');
+        a.href = URL.createObjectURL(blob);
+        a.download = name;
+        a.click();
+        URL.revokeObjectURL(a.href);
+      },
+      TRACE_FILE);
+#else
+  printf("Wrote %s\n", TRACE_FILE);
+#endif
+}
+
+// Text of the pause layer, shown over the plot while paused
+static void drawPauseText(SDL_Renderer *renderer) {
+  Assets.label_pause.draw(renderer, 0, 0);
+}
+
+/*
+ * Stacks the layers of the window: the plot, the text below it, the border
+ * and the overlays. Only the plot and whatever layer is invalidated change
+ * from frame to frame, the rest is drawn once.
+ */
+static void initLayers() {
+  Compositor &c = Assets.layers;
+  c.init(Assets.renderer, SDL_Color{0xFF, 0xFF, 0xFF, 0xFF});
+  Assets.layer_plot = c.addTexture(Assets.dstrect, Assets.screenTexture);
+  Assets.layer_text = c.addLayer(Assets.textrect, drawText);
+  Assets.layer_frame = c.addLayer(Assets.dstrect, drawFrame);
+  const SDL_Rect profile = {5, 5, 230,
+                            (PHASE_COUNT + 2) * Assets.glyphs.height + 10};
+  Assets.layer_profile = c.addLayer(profile, drawProfile);
+  const SDL_Rect pause = {20, 200, Assets.label_pause.w, Assets.label_pause.h};
+  Assets.layer_pause = c.addLayer(pause, drawPauseText);
+  if (Assets.layer_text < 0 || Assets.layer_frame < 0 ||
+      Assets.layer_profile < 0 || Assets.layer_pause < 0) {
+    exit(-1);
+  }
+  c.show(Assets.layer_profile, false);
+  c.show(Assets.layer_pause, false);
+}
+
+// Composes and presents a frame without sampling, while paused
+static void presentPaused() {
+  Assets.layers.compose();
+  SDL_RenderPresent(Assets.renderer);
 }
 
 // Initialize SDL, TTF
@@ -194,7 +391,6 @@ static void initSDL() {
   Assets.window = nullptr;
   Assets.renderer = nullptr;
   Assets.surface = nullptr;
-  Assets.surface_bg = nullptr;
   if (SDL_Init(SDL_INIT_VIDEO) < 0) {
     printf("Could not initialize! Error: %s\n", SDL_GetError());
     exit(-1);
@@ -206,7 +402,9 @@ static void initSDL() {
     printf("Window could not be created! SDL_Error: %s\n", SDL_GetError());
   }
   Assets.renderer =
-      SDL_CreateRenderer(Assets.window, -1, SDL_RENDERER_ACCELERATED);
+      SDL_CreateRenderer(Assets.window, -1,
+                         SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC |
+                             SDL_RENDERER_TARGETTEXTURE);
   if (!Assets.renderer) {
     printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
   }
@@ -217,11 +415,17 @@ static void initSDL() {
   // Fill the surface with white
   Uint32 white = SDL_MapRGB(Assets.surface->format, 255, 255, 255);
   SDL_FillRect(Assets.surface, NULL, white);
-
-  Assets.surface_bg = SDL_CreateRGBSurface(0, WIDTH, HEIGHT, 32, 0, 0, 0, 0);
-  if (!Assets.surface_bg) {
-    printf("surface bg could not be created! SDL Error: %s\n", SDL_GetError());
+  // The plot texture lives as long as the window and is updated in place
+  Assets.screenTexture = SDL_CreateTexture(
+      Assets.renderer, Assets.surface->format->format,
+      SDL_TEXTUREACCESS_STREAMING, Assets.surface->w, Assets.surface->h);
+  if (!Assets.screenTexture) {
+    printf("Error creating screenTexture: %s\n", SDL_GetError());
+    exit(-1);
   }
+  Assets.hits.resize(Assets.surface->w, Assets.surface->h);
+  Assets.dirty_bands = DIRTY_ALL;
+  uploadPixels();
 
   if (TTF_Init() < 0) {
     printf("TTF_Init() could not be initialized! SDL Error: %s\n",
@@ -238,20 +442,41 @@ static void initSDL() {
     printf("TTF_OpenFont coud not be created: %s\n", TTF_GetError());
     exit(-1);
   }
+  // Rasterize all text once, the text layers only compose it
+  if (!Assets.glyphs.build(Assets.renderer, Assets.font) ||
+      !Assets.label_pi.build(Assets.renderer, Assets.font,
+                             "Approximation of Pi: ", Assets.textColor) ||
+      !Assets.label_n.build(Assets.renderer, Assets.font, "Random pixels: ",
+                            Assets.textColor) ||
+      !Assets.label_inside.build(Assets.renderer, Assets.font,
+                                 "Random pixels with radii <= 1: ",
+                                 Assets.textColor) ||
+      !Assets.label_ci.build(Assets.renderer, Assets.font, "95% CI: +- ",
+                             Assets.textColor) ||
+      !Assets.label_pause.build(Assets.renderer, Assets.font_large,
+                                "Paused. Right click to reset.",
+                                Assets.textColor)) {
+    exit(-1);
+  }
+  initLayers();
 
   // Init timing
-  Assets.runtime = SDL_GetTicks64();
+  Assets.schedule.restart();
 }
 
 // Clean up SDL,TTF
 static void exitSDL() {
+  Assets.layers.destroy();
+  Assets.glyphs.destroy();
+  Assets.label_pi.destroy();
+  Assets.label_n.destroy();
+  Assets.label_inside.destroy();
+  Assets.label_ci.destroy();
+  Assets.label_pause.destroy();
   TTF_CloseFont(Assets.font);
   TTF_CloseFont(Assets.font_large);
   TTF_Quit();
-  SDL_FreeSurface(Assets.surface_bg);
   SDL_FreeSurface(Assets.surface);
-  if (Assets.backgroundTexture)
-    SDL_DestroyTexture(Assets.backgroundTexture);
   if (Assets.screenTexture)
     SDL_DestroyTexture(Assets.screenTexture);
   SDL_DestroyRenderer(Assets.renderer);
@@ -259,119 +484,110 @@ static void exitSDL() {
   SDL_Quit();
 }
 
+// Writes the run and the hit counts to the checkpoint file
+static void saveState() {
+  Assets.last_checkpoint = SDL_GetTicks();
+  if (!Assets.checkpoint)
+    return;
+  if (!saveCheckpoint(Assets.checkpoint, MonteCarlo, &Assets.hits)) {
+    printf("Could not write checkpoint %s\n", Assets.checkpoint);
+    return;
+  }
+#ifdef __EMSCRIPTEN__
+  // Flush MEMFS to IndexedDB in the background
+  EM_ASM(FS.syncfs(false, function(err) {
+    if (err)
+      console.error('checkpoint sync failed', err);
+  }););
+#endif
+}
+
+// Continues the run of the checkpoint file, if there is one
+static void restoreState() {
+  if (!Assets.checkpoint ||
+      !loadCheckpoint(Assets.checkpoint, MonteCarlo, &Assets.hits))
+    return;
+  Assets.dirty_bands = DIRTY_ALL;
+  Assets.schedule.batch = 1;
+  Assets.schedule.restart();
+  Assets.last_checkpoint = SDL_GetTicks();
+}
+
+#ifdef __EMSCRIPTEN__
+// Called back once IDBFS has been loaded from IndexedDB
+extern "C" EMSCRIPTEN_KEEPALIVE void mcp_restore() { restoreState(); }
+#endif
+
+// Starts a new run and resumes drawing
 static void reset_loop() {
-  MonteCarlo.n = 0;
-  MonteCarlo.p_count = 0;
-  Assets.random_pixels = 1;
-  Assets.prev_len = 0;
-  Assets.runtime = SDL_GetTicks64();
+  MonteCarlo.reset(randomSeed());
+  Assets.schedule.batch = 1;
+  Assets.schedule.restart();
   Uint32 white = SDL_MapRGB(Assets.surface->format, 255, 255, 255);
   SDL_LockSurface(Assets.surface);
   SDL_FillRect(Assets.surface, NULL, white);
   SDL_UnlockSurface(Assets.surface);
-  SDL_LockSurface(Assets.surface_bg);
-  SDL_FillRect(Assets.surface_bg, NULL, white);
-  SDL_UnlockSurface(Assets.surface_bg);
-  if (Assets.screenTexture)
-    SDL_DestroyTexture(Assets.screenTexture);
-
-  Assets.screenTexture =
-      SDL_CreateTextureFromSurface(Assets.renderer, Assets.surface_bg);
+  Assets.hits.clear();
+  Assets.knee = 1;
+  Assets.dirty_bands = DIRTY_ALL;
+  uploadPixels();
+  updateText();
 
-  SDL_RenderCopy(Assets.renderer, Assets.screenTexture, NULL, NULL);
-  drawText();
-  SDL_SetRenderDrawColor(Assets.renderer, 0, 0, 0, 0xFF);
-  SDL_RenderDrawRect(Assets.renderer, &Assets.dstrect);
-  SDL_RenderReadPixels(Assets.renderer, NULL, SDL_PIXELFORMAT_BGRA32,
-                       Assets.surface_bg->pixels, Assets.surface_bg->pitch);
-
-  if (Assets.backgroundTexture) {
-    SDL_DestroyTexture(Assets.backgroundTexture);
-    Assets.backgroundTexture = nullptr;
-  }
-  if (Assets.surface_bg == nullptr) {
-    printf("Invalid surface_bg\n");
-    exit(-1);
-  }
-  Assets.backgroundTexture =
-      SDL_CreateTextureFromSurface(Assets.renderer, Assets.surface_bg);
-
-  Assets.pause = !Assets.pause;
+  Assets.pause = false;
+  Assets.layers.show(Assets.layer_pause, false);
+  // Don't let a reload bring back the discarded run
+  saveState();
 }
 
-static void render_out() {
-  if (MonteCarlo.n >= LONG_MAX) {
-    reset_loop();
-  }
-  // every loop does >= 1 render of pixels
-  SDL_SetRenderDrawColor(Assets.renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-  SDL_RenderClear(Assets.renderer);
-
+// Draws one frame, returns the number of samples it added
+static size_t render_out() {
   // Timing settings
-  Uint64 new_runtime = SDL_GetTicks64();
-  double frametime = (new_runtime - Assets.runtime) / 6000.0F;
-  Assets.runtime = new_runtime;
-  Assets.time_acc += frametime;
-  while (Assets.time_acc >= Assets.time_delta) {
-    Assets.time_acc -= Assets.time_delta;
-    if (Assets.random_pixels > Assets.prev_len &&
-        Assets.random_pixels <= UINT64_MAX >> 1) {
-      Assets.prev_len = Assets.random_pixels;
-      Assets.random_pixels += log(Assets.random_pixels + 3);
-    }
+  double frame_ms = Assets.schedule.beginFrame();
+  Uint64 work_start = SDL_GetPerformanceCounter();
 
-    // Shift colors to make the render more visual
-    if (MonteCarlo.n % 17 == 0) {
-      Assets.blue.g =
-          Assets.blue.g + 25 > 155 ? Assets.blue.g = 0 : Assets.blue.g + 25;
-    }
-    if (MonteCarlo.n % 13 == 0) {
-      Assets.red.g =
-          Assets.red.g - 25 < 0 ? Assets.red.g = 155 : Assets.red.g - 25;
-    }
-    Assets.blue.b =
-        Assets.blue.b + 1 > 255 ? Assets.blue.b = 200 : Assets.blue.b + 1;
-    Assets.red.r =
-        Assets.red.r + 1 > 255 ? Assets.red.r = 200 : Assets.red.r + 1;
-    // randomize new pixels
-    auto ps = getRandomPixels(Assets.random_pixels);
-    // Render calls
-    drawPixels(ps, Assets.blue, Assets.red);
+  // randomize new pixels
+  const SampleBlock &ps = getRandomPixels(Assets.schedule.batch);
+  // Render calls
+  accumulatePixels(ps.samples);
+  resolvePixels(Assets.blue, Assets.red);
+  // update the plot layer in place
+  if (Assets.dirty_bands)
+    uploadPixels();
+  Assets.schedule.update(
+      static_cast<long>(ps.samples.size()),
+      Scheduler::toMs(SDL_GetPerformanceCounter() - work_start), frame_ms);
+  updateText();
+  Assets.layers.show(Assets.layer_profile, Assets.profile.enabled);
+  if (Assets.profile.enabled)
+    Assets.layers.invalidate(Assets.layer_profile);
+  {
+    PROFILE_SCOPE(Assets.profile, PHASE_COMPOSE);
+    Assets.layers.compose();
   }
-  // render pixel-surface and text-surface
-  SDL_RenderCopy(Assets.renderer, Assets.screenTexture, NULL, &Assets.dstrect);
-  drawText();
-  SDL_SetRenderDrawColor(Assets.renderer, 0, 0, 0, 0xFF);
-  SDL_RenderDrawRect(Assets.renderer, &Assets.dstrect);
+  if (SDL_GetTicks() - Assets.last_checkpoint >= CHECKPOINT_INTERVAL_MS)
+    saveState();
+  return ps.samples.size();
 }
 
+// Pausing shows the pause layer over the last frame, nothing is redrawn
 static void pause_loop() {
   Assets.pause = !Assets.pause;
-  Assets.runtime = SDL_GetTicks64();
-  if (Assets.pause) {
-    render_out();
-    if (!Assets.surface_bg) {
-      printf("No surface_bg error: %s\n", SDL_GetError());
-      exit(-1);
-    }
-    SDL_LockSurface(Assets.surface_bg);
-    SDL_RenderReadPixels(Assets.renderer, NULL, SDL_PIXELFORMAT_BGRA32,
-                         Assets.surface_bg->pixels, Assets.surface_bg->pitch);
-
-    SDL_UnlockSurface(Assets.surface_bg);
-    if (Assets.backgroundTexture) {
-      SDL_DestroyTexture(Assets.backgroundTexture);
-      Assets.backgroundTexture = nullptr;
-    }
-    Assets.backgroundTexture =
-        SDL_CreateTextureFromSurface(Assets.renderer, Assets.surface_bg);
-
-    // Render it
-    SDL_SetRenderDrawColor(Assets.renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-    SDL_RenderClear(Assets.renderer);
-    SDL_RenderCopy(Assets.renderer, Assets.backgroundTexture, NULL, NULL);
-    drawPauseText();
-    SDL_RenderPresent(Assets.renderer);
+  Assets.schedule.restart();
+  Assets.profile.skipFrame();
+  Assets.layers.show(Assets.layer_pause, Assets.pause);
+  if (Assets.pause)
+    presentPaused();
+}
+
+// Restarts the run with another sampling mode, keeps the pause state
+static void selectMode(SampleMode mode) {
+  bool pause = Assets.pause;
+  MonteCarlo.mode = mode;
+  reset_loop();
+  if (pause) {
+    Assets.pause = true;
+    Assets.layers.show(Assets.layer_pause, true);
+    presentPaused();
   }
 }
 
@@ -393,20 +609,94 @@ static void SDL_Loop() {
         reset_loop();
       }
     }
+    // Keys 1-5 pick the sampling mode
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym >= SDLK_1 &&
+        e.key.keysym.sym < SDLK_1 + SAMPLE_MODES) {
+      selectMode(static_cast<SampleMode>(e.key.keysym.sym - SDLK_1));
+    }
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3) {
+      Assets.profile.enabled = !Assets.profile.enabled;
+      if (Assets.profile.enabled)
+        Assets.profile.start();
+    }
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_t &&
+        Assets.profile.enabled) {
+      exportTrace();
+    }
+    // The contents of render targets are lost, e.g. on a resize
+    if (e.type == SDL_RENDER_TARGETS_RESET) {
+      Assets.layers.invalidateAll();
+      if (Assets.pause)
+        presentPaused();
+    }
   }
   if (!Assets.pause) {
-    render_out();
-    SDL_RenderPresent(Assets.renderer);
+    size_t samples = render_out();
+    {
+      PROFILE_SCOPE(Assets.profile, PHASE_PRESENT);
+      SDL_RenderPresent(Assets.renderer);
+    }
+    Assets.profile.endFrame(samples);
   }
 }
 int main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    return runBench(argc - 1, argv + 1);
+  unsigned threads = 0;
+  // An explicit seed or mode asks for a new run, not the checkpointed one
+  bool resume = true;
+  for (int i = 1; i < argc; i++) {
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (strcmp(argv[i], "--fresh") == 0) {
+      resume = false;
+    } else if (value && strcmp(argv[i], "--seed") == 0) {
+      MonteCarlo.seed = strtoull(value, nullptr, 0);
+      resume = false;
+      i++;
+    } else if (value && strcmp(argv[i], "--threads") == 0) {
+      threads = strtoul(value, nullptr, 0);
+      i++;
+    } else if (value && strcmp(argv[i], "--mode") == 0 &&
+               sampleModeByName(value) != SAMPLE_MODES) {
+      MonteCarlo.mode = sampleModeByName(value);
+      resume = false;
+      i++;
+    } else if (value && strcmp(argv[i], "--checkpoint") == 0) {
+      Assets.checkpoint = strcmp(value, "none") == 0 ? nullptr : value;
+      i++;
+    } else {
+      printf("Usage: %s [--seed n] [--threads n] [--mode name] [--fresh]\n"
+             "          [--checkpoint file|none]\n"
+             "       %s --bench [options], see bench.cpp\n",
+             argv[0], argv[0]);
+      exit(-1);
+    }
+  }
+  MonteCarlo.pool.start(threads, SAMPLE_CAPACITY);
   initSDL();
 #ifdef __EMSCRIPTEN__
+  // IDBFS loads asynchronously, the run is restored from its callback
+  if (Assets.checkpoint) {
+    EM_ASM(
+        {
+          FS.mkdir(UTF8ToString($0));
+          FS.mount(IDBFS, {}, UTF8ToString($0));
+          FS.syncfs(true, function(err) {
+            if ($1 && !err)
+              Module.ccall('mcp_restore', null, [], []);
+          });
+        },
+        CHECKPOINT_DIR, resume);
+  }
   emscripten_set_main_loop(SDL_Loop, 0, 1);
 #else
+  if (resume)
+    restoreState();
   while (Assets.quit == false) {
     SDL_Loop();
   }
+  saveState();
 #endif
+  MonteCarlo.pool.stop();
   exitSDL();
 }
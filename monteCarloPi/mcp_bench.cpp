@@ -0,0 +1,3 @@
+#include "montecarlo.h"
+
+int main(int argc, char *argv[]) { return runBench(argc, argv); }
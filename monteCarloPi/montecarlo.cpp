@@ -0,0 +1,65 @@
+#include "montecarlo.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+uint64_t randomSeed() {
+  std::random_device rd;
+  return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+MonteCarlo::MonteCarlo() : seed(randomSeed()) {}
+
+const SampleBlock &MonteCarlo::step(size_t num_samples,
+                                    const SampleGrid &grid) {
+  const SampleBlock &ready = pool.collect();
+  addReplicates(ready);
+  n += ready.samples.size();
+  p_count += ready.inside;
+  if (num_samples > 0)
+    pool.submit(mode, seed, n, num_samples, grid);
+  return ready;
+}
+
+// Folds the replicates the block finishes into the running mean and
+// variance, from the per replicate counts of the workers
+void MonteCarlo::addReplicates(const SampleBlock &block) {
+  uint64_t index = block.first;
+  const uint64_t end = block.first + block.samples.size();
+  for (uint32_t inside : block.replicate_inside) {
+    open_inside += inside;
+    index = std::min(end, (index / SAMPLE_REPLICATE + 1) * SAMPLE_REPLICATE);
+    if (index % SAMPLE_REPLICATE)
+      continue;
+    double estimate = 4.0 * open_inside / SAMPLE_REPLICATE;
+    double delta = estimate - replicate_mean;
+    replicates++;
+    replicate_mean += delta / replicates;
+    replicate_m2 += delta * (estimate - replicate_mean);
+    open_inside = 0;
+  }
+}
+
+void MonteCarlo::reset(uint64_t seed) {
+  pool.collect();
+  n = 0;
+  p_count = 0;
+  replicates = 0;
+  replicate_mean = 0;
+  replicate_m2 = 0;
+  open_inside = 0;
+  this->seed = seed;
+}
+
+long double MonteCarlo::pi() const {
+  if (n == 0)
+    return 0;
+  return (4L * (long double)p_count) / n;
+}
+
+double MonteCarlo::stderror() const {
+  if (replicates < 2)
+    return 0;
+  double variance = replicate_m2 / (replicates - 1);
+  return std::sqrt(variance / replicates);
+}
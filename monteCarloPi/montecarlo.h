@@ -0,0 +1,55 @@
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include "sampler_pool.h"
+#include <cstdint>
+
+/*
+ * Estimator state for the approximation of Pi, free of any SDL dependency
+ * so it can run headless (see bench.cpp). Sample i of a run is a function
+ * of (seed, i) only, so n doubles as the position in the sample stream.
+ *
+ * The standard error comes from the spread of the estimates of whole
+ * replicates (SAMPLE_REPLICATE samples each), which is valid for the quasi
+ * Monte Carlo modes too where the samples are not independent.
+ */
+struct MonteCarlo {
+  // 64-bit on every target, long is 32 bits on wasm32
+  uint64_t n = 0;
+  uint64_t p_count = 0;
+  uint64_t seed;
+  SampleMode mode = SAMPLE_RANDOM;
+  SamplerPool pool;
+
+  // Welford accumulators over the replicate estimates of Pi
+  uint64_t replicates = 0;
+  double replicate_mean = 0;
+  double replicate_m2 = 0;
+  uint64_t open_inside = 0; // Inside count of the unfinished replicate
+
+  MonteCarlo();
+  /* step(num_samples, grid) -> const SampleBlock &
+   * Returns the block started by the previous step and starts num_samples
+   * new ones on the pool. n and p_count are updated with the returned block.
+   */
+  const SampleBlock &step(size_t num_samples, const SampleGrid &grid);
+  // Drops the block in flight and starts a new run from seed
+  void reset(uint64_t seed);
+  // 4 * p_count / n
+  long double pi() const;
+  // Standard error of pi(), 0 until two replicates are complete
+  double stderror() const;
+  // Half width of the 95% confidence interval
+  double ci95() const { return 1.96 * stderror(); }
+
+private:
+  void addReplicates(const SampleBlock &block);
+};
+
+// Returns a fresh seed for the sample stream
+uint64_t randomSeed();
+
+// Headless benchmark, see bench.cpp for the options
+int runBench(int argc, char *argv[]);
+
+#endif
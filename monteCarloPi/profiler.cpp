@@ -0,0 +1,102 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+const char *const PHASE_NAMES[PHASE_COUNT] = {
+    "frame", "sample", "accumulate", "resolve",
+    "upload", "compose", "text",     "present"};
+
+uint64_t Profiler::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Profiler::start() {
+  events.assign(PROFILE_EVENTS, Event());
+  frames.assign(PROFILE_FRAMES, Frame());
+  event_count = 0;
+  frame_count = 0;
+  current = Frame();
+  origin = now();
+  frame_begin = origin;
+}
+
+void Profiler::skipFrame() {
+  current = Frame();
+  frame_begin = now();
+}
+
+void Profiler::record(ProfilePhase phase, uint64_t begin, uint64_t end) {
+  // Durations are capped at 4 s, anything longer is a stall, not a phase
+  uint64_t duration = std::min<uint64_t>(end - begin, UINT32_MAX);
+  Event &e = events[event_count++ % PROFILE_EVENTS];
+  e.begin = begin - origin;
+  e.duration = static_cast<uint32_t>(duration);
+  e.phase = phase;
+  current.ms[phase] += duration * 1e-6;
+}
+
+void Profiler::endFrame(uint64_t samples) {
+  if (!enabled)
+    return;
+  uint64_t t = now();
+  record(PHASE_FRAME, frame_begin, t);
+  current.samples = samples;
+  frames[frame_count++ % PROFILE_FRAMES] = current;
+  current = Frame();
+  frame_begin = t;
+}
+
+double Profiler::phaseMs(ProfilePhase phase) const {
+  size_t n = std::min(frame_count, PROFILE_FRAMES);
+  if (n == 0)
+    return 0;
+  double sum = 0;
+  for (size_t i = 0; i < n; i++)
+    sum += frames[i].ms[phase];
+  return sum / n;
+}
+
+double Profiler::frameMs(double percentile) const {
+  size_t n = std::min(frame_count, PROFILE_FRAMES);
+  if (n == 0)
+    return 0;
+  double ms[PROFILE_FRAMES];
+  for (size_t i = 0; i < n; i++)
+    ms[i] = frames[i].ms[PHASE_FRAME];
+  size_t k = static_cast<size_t>(percentile / 100.0 * (n - 1) + 0.5);
+  std::nth_element(ms, ms + k, ms + n);
+  return ms[k];
+}
+
+double Profiler::samplesPerSec() const {
+  size_t n = std::min(frame_count, PROFILE_FRAMES);
+  double ms = 0;
+  double samples = 0;
+  for (size_t i = 0; i < n; i++) {
+    ms += frames[i].ms[PHASE_FRAME];
+    samples += frames[i].samples;
+  }
+  return ms > 0 ? samples * 1000.0 / ms : 0;
+}
+
+bool Profiler::exportTrace(const char *path) const {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  size_t n = std::min(event_count, PROFILE_EVENTS);
+  // Oldest first, timestamps and durations in microseconds
+  for (size_t i = event_count - n; i < event_count; i++) {
+    const Event &e = events[i % PROFILE_EVENTS];
+    fprintf(f,
+            "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+            "\"ts\": %.3f, \"dur\": %.3f}",
+            i + n == event_count ? "" : ",\n", PHASE_NAMES[e.phase],
+            e.phase == PHASE_FRAME ? 0 : 1, e.begin * 1e-3, e.duration * 1e-3);
+  }
+  fprintf(f, "\n]}\n");
+  return fclose(f) == 0;
+}
@@ -0,0 +1,95 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Frame profiler for the viewer. Phases of a frame are timed with
+ * PROFILE_SCOPE, every timed scope becomes one event in a fixed size ring
+ * buffer and adds to the per phase totals of the current frame. Nothing is
+ * allocated while running, and while the profiler is disabled a scope costs
+ * a single branch.
+ *
+ * The last PROFILE_FRAMES frames feed the statistics of the overlay, the
+ * last PROFILE_EVENTS events can be written as a Chrome trace (load it in
+ * chrome://tracing or ui.perfetto.dev).
+ */
+
+enum ProfilePhase {
+  PHASE_FRAME,      // Whole frame, start to start
+  PHASE_SAMPLE,     // getRandomPixels, waiting for the pool
+  PHASE_ACCUMULATE, // Samples into hit counts
+  PHASE_RESOLVE,    // Hit counts into the surface
+  PHASE_UPLOAD,     // Surface into the streaming texture
+  PHASE_COMPOSE,    // Compositor::compose, redraws dirty layers
+  PHASE_TEXT,       // updateText, formatting the numbers
+  PHASE_PRESENT,    // SDL_RenderPresent, includes the vsync wait
+  PHASE_COUNT
+};
+extern const char *const PHASE_NAMES[PHASE_COUNT];
+
+const size_t PROFILE_EVENTS = 1 << 15;
+const size_t PROFILE_FRAMES = 128;
+
+struct Profiler {
+  bool enabled = false;
+
+  // Nanoseconds on a monotonic clock
+  static uint64_t now();
+  // Clears the history and starts timing
+  void start();
+  // Drops the frame in progress, after a pause
+  void skipFrame();
+  // Closes the current frame, samples is the number drawn in it
+  void endFrame(uint64_t samples);
+  void record(ProfilePhase phase, uint64_t begin, uint64_t end);
+
+  // Mean ms of a phase per frame over the frame history
+  double phaseMs(ProfilePhase phase) const;
+  // Frame time percentile (0..100) over the frame history
+  double frameMs(double percentile) const;
+  double samplesPerSec() const;
+  // Writes the event ring as Chrome trace event JSON
+  bool exportTrace(const char *path) const;
+
+private:
+  struct Event {
+    uint64_t begin; // ns since origin
+    uint32_t duration;
+    uint32_t phase;
+  };
+  struct Frame {
+    double ms[PHASE_COUNT];
+    uint64_t samples;
+  };
+  std::vector<Event> events;
+  std::vector<Frame> frames;
+  size_t event_count = 0; // Events recorded, the ring keeps the last ones
+  size_t frame_count = 0;
+  Frame current = {};
+  uint64_t origin = 0;
+  uint64_t frame_begin = 0;
+};
+
+// Times the enclosing scope as phase
+struct ProfileScope {
+  Profiler &profiler;
+  ProfilePhase phase;
+  uint64_t begin;
+
+  ProfileScope(Profiler &p, ProfilePhase phase)
+      : profiler(p), phase(phase), begin(p.enabled ? Profiler::now() : 0) {}
+  ~ProfileScope() {
+    if (profiler.enabled)
+      profiler.record(phase, begin, Profiler::now());
+  }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(profiler, phase)                                         \
+  ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(profiler, phase)
+
+#endif
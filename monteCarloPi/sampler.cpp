@@ -0,0 +1,477 @@
+#include "sampler.h"
+#include "integrator.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+void philox4x32(const uint32_t ctr[4], uint64_t key, uint32_t out[4]) {
+  uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+  uint32_t k0 = static_cast<uint32_t>(key);
+  uint32_t k1 = static_cast<uint32_t>(key >> 32);
+  for (int r = 0; r < PHILOX_ROUNDS; r++) {
+    uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+    uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+    c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    c1 = static_cast<uint32_t>(p1);
+    c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    c3 = static_cast<uint32_t>(p0);
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+// Portable path, also used for the unaligned head and the tail of a batch.
+// The vector kernels must give the same samples.
+static uint64_t sampleScalar(uint64_t seed, uint64_t first, size_t count,
+                             const SampleGrid &g, uint32_t *out) {
+  return integrate(UnitBall<2>(), seed, first, count, &g, out);
+}
+
+const char *const SAMPLE_MODE_NAMES[SAMPLE_MODES] = {
+    "random", "sobol", "halton", "stratified", "antithetic"};
+
+SampleMode sampleModeByName(const char *name) {
+  int m = 0;
+  while (m < SAMPLE_MODES && strcmp(name, SAMPLE_MODE_NAMES[m]) != 0)
+    m++;
+  return static_cast<SampleMode>(m);
+}
+
+// Philox counter word 2 keeps the streams of a seed apart
+static const uint32_t STREAM_SHIFT = 1; // Per replicate randomization
+static const uint32_t STREAM_POINT = 2; // Per sample jitter
+
+// Points in the quarter space modes are 24-bit fixed point fractions
+static const uint32_t FRACTION_BITS = 24;
+static const uint32_t FRACTION_MASK = (1u << FRACTION_BITS) - 1;
+static const uint32_t STRATA_BITS = 6; // 64x64 strata per replicate
+
+static inline void philoxAt(uint64_t n, uint32_t stream, uint64_t seed,
+                            uint32_t out[4]) {
+  uint32_t ctr[4] = {static_cast<uint32_t>(n), static_cast<uint32_t>(n >> 32),
+                     stream, 0};
+  philox4x32(ctr, seed, out);
+}
+
+static inline uint32_t reverseBits(uint32_t v) {
+  v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+  v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+  v = ((v >> 4) & 0x0F0F0F0Fu) | ((v & 0x0F0F0F0Fu) << 4);
+  v = ((v >> 8) & 0x00FF00FFu) | ((v & 0x00FF00FFu) << 8);
+  return (v >> 16) | (v << 16);
+}
+
+// Second Sobol coordinate, direction numbers v_k = v_(k-1) ^ (v_(k-1) >> 1)
+static inline uint32_t sobol2(uint32_t j) {
+  uint32_t x = 0;
+  for (uint32_t v = 0x80000000u; j; j >>= 1, v ^= v >> 1)
+    if (j & 1)
+      x ^= v;
+  return x;
+}
+
+// Radical inverse of j in base 3 as a fraction
+static inline uint32_t halton3(uint32_t j) {
+  double x = 0.0;
+  double scale = 1.0 / 3.0;
+  for (; j; j /= 3, scale /= 3.0)
+    x += (j % 3) * scale;
+  return static_cast<uint32_t>(x * (FRACTION_MASK + 1.0));
+}
+
+// Plots a quarter space point (u,v) mirrored into quadrant q (2 bits)
+static inline uint32_t plotQuarter(uint32_t u, uint32_t v, uint32_t q,
+                                   const SampleGrid &g) {
+  float fu = static_cast<float>(u) * SAMPLE_UNIT;
+  float fv = static_cast<float>(v) * SAMPLE_UNIT;
+  bool inside = fu * fu + fv * fv <= 1.0F;
+  float fx = 0.5F + (q & 1 ? -0.5F : 0.5F) * fu;
+  float fy = 0.5F + (q & 2 ? -0.5F : 0.5F) * fv;
+  uint32_t gridX = static_cast<uint32_t>(
+      std::min(fx * static_cast<float>(g.w), static_cast<float>(g.w - 1)));
+  uint32_t gridY = static_cast<uint32_t>(
+      std::min(fy * static_cast<float>(g.h), static_cast<float>(g.h - 1)));
+  uint32_t pixel_index = gridY * g.pitch + gridX * g.bytes;
+  return pixel_index | (inside ? SAMPLE_INSIDE : 0);
+}
+
+// Cheap quadrant for the low discrepancy modes, it only affects the plot
+static inline uint32_t quadrantOf(uint64_t i) {
+  return static_cast<uint32_t>((i * 0x9E3779B97F4A7C15ull) >> 62);
+}
+
+// Scalar generator for every mode but SAMPLE_RANDOM
+static uint64_t sampleModes(SampleMode mode, uint64_t seed, uint64_t first,
+                            size_t count, const SampleGrid &g, uint32_t *out) {
+  uint64_t inside = 0;
+  uint64_t replicate = ~0ull;
+  uint32_t shift[4] = {};
+  uint32_t r[4] = {};
+  for (uint64_t i = first; i < first + count; i++) {
+    const uint32_t j = static_cast<uint32_t>(i % SAMPLE_REPLICATE);
+    if (i / SAMPLE_REPLICATE != replicate) {
+      replicate = i / SAMPLE_REPLICATE;
+      philoxAt(replicate, STREAM_SHIFT, seed, shift);
+    }
+    uint32_t u, v, q;
+    switch (mode) {
+    case SAMPLE_SOBOL:
+      // Digital shift: XOR keeps the replicate a (0,m,2)-net
+      u = ((reverseBits(j) ^ shift[0]) >> 8);
+      v = ((sobol2(j) ^ shift[1]) >> 8);
+      q = quadrantOf(i);
+      break;
+    case SAMPLE_HALTON:
+      // Cranley-Patterson rotation modulo 1
+      u = ((reverseBits(j) >> 8) + (shift[0] >> 8)) & FRACTION_MASK;
+      v = (halton3(j) + (shift[1] >> 8)) & FRACTION_MASK;
+      q = quadrantOf(i);
+      break;
+    case SAMPLE_STRATIFIED: {
+      const uint32_t jitter = FRACTION_BITS - STRATA_BITS;
+      const uint32_t strata = (1u << STRATA_BITS) - 1;
+      philoxAt(i, STREAM_POINT, seed, r);
+      u = ((j & strata) << jitter) | (r[0] >> (32 - jitter));
+      v = (((j >> STRATA_BITS) & strata) << jitter) | (r[1] >> (32 - jitter));
+      q = r[2] >> 30;
+      break;
+    }
+    default: // SAMPLE_ANTITHETIC
+      // Both samples of a pair come from one block, the odd one reflected
+      philoxAt(i >> 1, STREAM_POINT, seed, r);
+      u = r[0] >> 8;
+      v = r[1] >> 8;
+      if (i & 1) {
+        u = FRACTION_MASK - u;
+        v = FRACTION_MASK - v;
+      }
+      q = r[2 + (i & 1)] >> 30;
+      break;
+    }
+    uint32_t s = plotQuarter(u, v, q, g);
+    inside += s >> 31;
+    *out++ = s;
+  }
+  return inside;
+}
+
+#if defined(__AVX2__)
+
+const char *const SAMPLER_KERNEL = "avx2";
+static const size_t LANES = 8;
+
+static inline void mulhilo(__m256i a, __m256i m, __m256i &hi, __m256i &lo) {
+  const __m256i lo_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+  __m256i even = _mm256_mul_epu32(a, m);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+  lo = _mm256_or_si256(_mm256_and_si256(even, lo_mask),
+                       _mm256_slli_epi64(odd, 32));
+  hi = _mm256_or_si256(_mm256_srli_epi64(even, 32),
+                       _mm256_andnot_si256(lo_mask, odd));
+}
+
+struct Plot {
+  __m256 w, h, w_max, h_max;
+  __m256i pitch, bytes;
+};
+
+static inline __m256i plot(__m256i wx, __m256i wy, const Plot &p,
+                           __m256i &count) {
+  const __m256 unit = _mm256_set1_ps(SAMPLE_UNIT);
+  const __m256 one = _mm256_set1_ps(1.0F);
+  __m256 fx = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(wx, 8)), unit);
+  __m256 fy = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(wy, 8)), unit);
+  __m256 x = _mm256_sub_ps(_mm256_add_ps(fx, fx), one);
+  __m256 y = _mm256_sub_ps(_mm256_add_ps(fy, fy), one);
+  __m256 r2 = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+  __m256i inside = _mm256_castps_si256(_mm256_cmp_ps(r2, one, _CMP_LE_OQ));
+  __m256i gx = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_mul_ps(fx, p.w), p.w_max));
+  __m256i gy = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_mul_ps(fy, p.h), p.h_max));
+  __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(gy, p.pitch),
+                                   _mm256_mullo_epi32(gx, p.bytes));
+  count = _mm256_sub_epi32(count, inside);
+  return _mm256_or_si256(
+      index, _mm256_and_si256(inside, _mm256_set1_epi32(SAMPLE_INSIDE)));
+}
+
+// Generates LANES pairs starting at pair, returns inside count
+static size_t sampleVector(uint64_t seed, uint64_t pair, size_t pairs,
+                           const SampleGrid &g, uint32_t *out) {
+  const Plot p = {_mm256_set1_ps(static_cast<float>(g.w)),
+                  _mm256_set1_ps(static_cast<float>(g.h)),
+                  _mm256_set1_ps(static_cast<float>(g.w - 1)),
+                  _mm256_set1_ps(static_cast<float>(g.h - 1)),
+                  _mm256_set1_epi32(g.pitch), _mm256_set1_epi32(g.bytes)};
+  const __m256i m0 = _mm256_set1_epi32(PHILOX_M0);
+  const __m256i m1 = _mm256_set1_epi32(PHILOX_M1);
+  __m256i rk0[PHILOX_ROUNDS], rk1[PHILOX_ROUNDS];
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+  for (int r = 0; r < PHILOX_ROUNDS; r++) {
+    rk0[r] = _mm256_set1_epi32(k0 + r * PHILOX_W0);
+    rk1[r] = _mm256_set1_epi32(k1 + r * PHILOX_W1);
+  }
+  __m256i count = _mm256_setzero_si256();
+  alignas(32) uint32_t lo[LANES], hi[LANES];
+  for (size_t done = 0; done < pairs; done += LANES) {
+    for (size_t k = 0; k < LANES; k++) {
+      uint64_t ctr = pair + done + k;
+      lo[k] = static_cast<uint32_t>(ctr);
+      hi[k] = static_cast<uint32_t>(ctr >> 32);
+    }
+    __m256i c0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(lo));
+    __m256i c1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(hi));
+    __m256i c2 = _mm256_setzero_si256();
+    __m256i c3 = _mm256_setzero_si256();
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+      __m256i hi0, lo0, hi1, lo1;
+      mulhilo(c0, m0, hi0, lo0);
+      mulhilo(c2, m1, hi1, lo1);
+      c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), rk0[r]);
+      c1 = lo1;
+      c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), rk1[r]);
+      c3 = lo0;
+    }
+    __m256i even = plot(c0, c1, p, count);
+    __m256i odd = plot(c2, c3, p, count);
+    // Interleave back into sample order, unpack works per 128-bit half
+    __m256i a = _mm256_unpacklo_epi32(even, odd);
+    __m256i b = _mm256_unpackhi_epi32(even, odd);
+    __m256i *dst = reinterpret_cast<__m256i *>(out + 2 * done);
+    _mm256_storeu_si256(dst, _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  alignas(32) uint32_t lanes[LANES];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), count);
+  size_t inside = 0;
+  for (size_t k = 0; k < LANES; k++)
+    inside += lanes[k];
+  return inside;
+}
+
+static bool vectorFits(const SampleGrid &) { return true; }
+
+#elif defined(__SSE2__)
+
+const char *const SAMPLER_KERNEL = "sse2";
+static const size_t LANES = 4;
+
+static inline void mulhilo(__m128i a, __m128i m, __m128i &hi, __m128i &lo) {
+  const __m128i lo_mask = _mm_set_epi32(0, -1, 0, -1);
+  __m128i even = _mm_mul_epu32(a, m);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+  lo = _mm_or_si128(_mm_and_si128(even, lo_mask), _mm_slli_epi64(odd, 32));
+  hi = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(lo_mask, odd));
+}
+
+struct Plot {
+  __m128 w, h, w_max, h_max, pitch, bytes;
+};
+
+static inline __m128i plot(__m128i wx, __m128i wy, const Plot &p,
+                           __m128i &count) {
+  const __m128 unit = _mm_set1_ps(SAMPLE_UNIT);
+  const __m128 one = _mm_set1_ps(1.0F);
+  __m128 fx = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(wx, 8)), unit);
+  __m128 fy = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(wy, 8)), unit);
+  __m128 x = _mm_sub_ps(_mm_add_ps(fx, fx), one);
+  __m128 y = _mm_sub_ps(_mm_add_ps(fy, fy), one);
+  __m128 r2 = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+  __m128i inside = _mm_castps_si128(_mm_cmple_ps(r2, one));
+  // SSE2 has no 32-bit multiply, the index is exact in float as long as
+  // the grid is below 2^24 bytes (see vectorFits)
+  __m128 gx = _mm_cvtepi32_ps(
+      _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(fx, p.w), p.w_max)));
+  __m128 gy = _mm_cvtepi32_ps(
+      _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(fy, p.h), p.h_max)));
+  __m128i index = _mm_cvttps_epi32(
+      _mm_add_ps(_mm_mul_ps(gy, p.pitch), _mm_mul_ps(gx, p.bytes)));
+  count = _mm_sub_epi32(count, inside);
+  return _mm_or_si128(index,
+                      _mm_and_si128(inside, _mm_set1_epi32(SAMPLE_INSIDE)));
+}
+
+static size_t sampleVector(uint64_t seed, uint64_t pair, size_t pairs,
+                           const SampleGrid &g, uint32_t *out) {
+  const Plot p = {_mm_set1_ps(static_cast<float>(g.w)),
+                  _mm_set1_ps(static_cast<float>(g.h)),
+                  _mm_set1_ps(static_cast<float>(g.w - 1)),
+                  _mm_set1_ps(static_cast<float>(g.h - 1)),
+                  _mm_set1_ps(static_cast<float>(g.pitch)),
+                  _mm_set1_ps(static_cast<float>(g.bytes))};
+  const __m128i m0 = _mm_set1_epi32(PHILOX_M0);
+  const __m128i m1 = _mm_set1_epi32(PHILOX_M1);
+  __m128i rk0[PHILOX_ROUNDS], rk1[PHILOX_ROUNDS];
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+  for (int r = 0; r < PHILOX_ROUNDS; r++) {
+    rk0[r] = _mm_set1_epi32(k0 + r * PHILOX_W0);
+    rk1[r] = _mm_set1_epi32(k1 + r * PHILOX_W1);
+  }
+  __m128i count = _mm_setzero_si128();
+  alignas(16) uint32_t lo[LANES], hi[LANES];
+  for (size_t done = 0; done < pairs; done += LANES) {
+    for (size_t k = 0; k < LANES; k++) {
+      uint64_t ctr = pair + done + k;
+      lo[k] = static_cast<uint32_t>(ctr);
+      hi[k] = static_cast<uint32_t>(ctr >> 32);
+    }
+    __m128i c0 = _mm_load_si128(reinterpret_cast<const __m128i *>(lo));
+    __m128i c1 = _mm_load_si128(reinterpret_cast<const __m128i *>(hi));
+    __m128i c2 = _mm_setzero_si128();
+    __m128i c3 = _mm_setzero_si128();
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+      __m128i hi0, lo0, hi1, lo1;
+      mulhilo(c0, m0, hi0, lo0);
+      mulhilo(c2, m1, hi1, lo1);
+      c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), rk0[r]);
+      c1 = lo1;
+      c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), rk1[r]);
+      c3 = lo0;
+    }
+    __m128i even = plot(c0, c1, p, count);
+    __m128i odd = plot(c2, c3, p, count);
+    __m128i *dst = reinterpret_cast<__m128i *>(out + 2 * done);
+    _mm_storeu_si128(dst, _mm_unpacklo_epi32(even, odd));
+    _mm_storeu_si128(dst + 1, _mm_unpackhi_epi32(even, odd));
+  }
+  alignas(16) uint32_t lanes[LANES];
+  _mm_store_si128(reinterpret_cast<__m128i *>(lanes), count);
+  return static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+
+static bool vectorFits(const SampleGrid &g) {
+  return static_cast<uint64_t>(g.h) * g.pitch < (1u << 24);
+}
+
+#elif defined(__wasm_simd128__)
+
+const char *const SAMPLER_KERNEL = "simd128";
+static const size_t LANES = 4;
+
+static inline void mulhilo(v128_t a, v128_t m, v128_t &hi, v128_t &lo) {
+  v128_t p_lo = wasm_u64x2_extmul_low_u32x4(a, m);
+  v128_t p_hi = wasm_u64x2_extmul_high_u32x4(a, m);
+  lo = wasm_i32x4_shuffle(p_lo, p_hi, 0, 2, 4, 6);
+  hi = wasm_i32x4_shuffle(p_lo, p_hi, 1, 3, 5, 7);
+}
+
+struct Plot {
+  v128_t w, h, w_max, h_max, pitch, bytes;
+};
+
+static inline v128_t plot(v128_t wx, v128_t wy, const Plot &p, v128_t &count) {
+  const v128_t unit = wasm_f32x4_splat(SAMPLE_UNIT);
+  const v128_t one = wasm_f32x4_splat(1.0F);
+  v128_t fx = wasm_f32x4_mul(wasm_f32x4_convert_i32x4(wasm_u32x4_shr(wx, 8)), unit);
+  v128_t fy = wasm_f32x4_mul(wasm_f32x4_convert_i32x4(wasm_u32x4_shr(wy, 8)), unit);
+  v128_t x = wasm_f32x4_sub(wasm_f32x4_add(fx, fx), one);
+  v128_t y = wasm_f32x4_sub(wasm_f32x4_add(fy, fy), one);
+  v128_t r2 = wasm_f32x4_add(wasm_f32x4_mul(x, x), wasm_f32x4_mul(y, y));
+  v128_t inside = wasm_f32x4_le(r2, one);
+  v128_t gx = wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_min(wasm_f32x4_mul(fx, p.w), p.w_max));
+  v128_t gy = wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_min(wasm_f32x4_mul(fy, p.h), p.h_max));
+  v128_t index = wasm_i32x4_add(wasm_i32x4_mul(gy, p.pitch),
+                                wasm_i32x4_mul(gx, p.bytes));
+  count = wasm_i32x4_sub(count, inside);
+  return wasm_v128_or(index,
+                      wasm_v128_and(inside, wasm_i32x4_splat(SAMPLE_INSIDE)));
+}
+
+static size_t sampleVector(uint64_t seed, uint64_t pair, size_t pairs,
+                           const SampleGrid &g, uint32_t *out) {
+  const Plot p = {wasm_f32x4_splat(static_cast<float>(g.w)),
+                  wasm_f32x4_splat(static_cast<float>(g.h)),
+                  wasm_f32x4_splat(static_cast<float>(g.w - 1)),
+                  wasm_f32x4_splat(static_cast<float>(g.h - 1)),
+                  wasm_i32x4_splat(g.pitch), wasm_i32x4_splat(g.bytes)};
+  const v128_t m0 = wasm_i32x4_splat(PHILOX_M0);
+  const v128_t m1 = wasm_i32x4_splat(PHILOX_M1);
+  v128_t rk0[PHILOX_ROUNDS], rk1[PHILOX_ROUNDS];
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+  for (int r = 0; r < PHILOX_ROUNDS; r++) {
+    rk0[r] = wasm_i32x4_splat(k0 + r * PHILOX_W0);
+    rk1[r] = wasm_i32x4_splat(k1 + r * PHILOX_W1);
+  }
+  v128_t count = wasm_i32x4_splat(0);
+  for (size_t done = 0; done < pairs; done += LANES) {
+    uint64_t ctr = pair + done;
+    v128_t c0 = wasm_i32x4_make(
+        static_cast<uint32_t>(ctr), static_cast<uint32_t>(ctr + 1),
+        static_cast<uint32_t>(ctr + 2), static_cast<uint32_t>(ctr + 3));
+    v128_t c1 = wasm_i32x4_make(static_cast<uint32_t>(ctr >> 32),
+                                static_cast<uint32_t>((ctr + 1) >> 32),
+                                static_cast<uint32_t>((ctr + 2) >> 32),
+                                static_cast<uint32_t>((ctr + 3) >> 32));
+    v128_t c2 = wasm_i32x4_splat(0);
+    v128_t c3 = wasm_i32x4_splat(0);
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+      v128_t hi0, lo0, hi1, lo1;
+      mulhilo(c0, m0, hi0, lo0);
+      mulhilo(c2, m1, hi1, lo1);
+      c0 = wasm_v128_xor(wasm_v128_xor(hi1, c1), rk0[r]);
+      c1 = lo1;
+      c2 = wasm_v128_xor(wasm_v128_xor(hi0, c3), rk1[r]);
+      c3 = lo0;
+    }
+    v128_t even = plot(c0, c1, p, count);
+    v128_t odd = plot(c2, c3, p, count);
+    uint32_t *dst = out + 2 * done;
+    wasm_v128_store(dst, wasm_i32x4_shuffle(even, odd, 0, 4, 1, 5));
+    wasm_v128_store(dst + 4, wasm_i32x4_shuffle(even, odd, 2, 6, 3, 7));
+  }
+  return static_cast<size_t>(static_cast<uint32_t>(wasm_i32x4_extract_lane(count, 0))) +
+         static_cast<uint32_t>(wasm_i32x4_extract_lane(count, 1)) +
+         static_cast<uint32_t>(wasm_i32x4_extract_lane(count, 2)) +
+         static_cast<uint32_t>(wasm_i32x4_extract_lane(count, 3));
+}
+
+static bool vectorFits(const SampleGrid &) { return true; }
+
+#else
+
+const char *const SAMPLER_KERNEL = "scalar";
+
+#endif
+
+uint64_t sampleBatch(SampleMode mode, uint64_t seed, uint64_t first,
+                     size_t count, const SampleGrid &grid, uint32_t *out) {
+  if (mode != SAMPLE_RANDOM)
+    return sampleModes(mode, seed, first, count, grid, out);
+#if defined(__AVX2__) || defined(__SSE2__) || defined(__wasm_simd128__)
+  // Lane counters are 32-bit, keep each vector call well below that
+  const size_t CHUNK_PAIRS = size_t(1) << 24;
+  if (!vectorFits(grid))
+    return sampleScalar(seed, first, count, grid, out);
+  uint64_t inside = 0;
+  // The vector kernel works on whole pairs, an odd first sample and the
+  // last few samples go through the scalar path.
+  if (first & 1 && count > 0) {
+    inside += sampleScalar(seed, first, 1, grid, out);
+    first++;
+    count--;
+    out++;
+  }
+  size_t pairs = (count / 2) / LANES * LANES;
+  for (size_t done = 0; done < pairs; done += CHUNK_PAIRS) {
+    size_t n = std::min(CHUNK_PAIRS, pairs - done);
+    inside += sampleVector(seed, (first >> 1) + done, n, grid, out + 2 * done);
+  }
+  size_t vector_samples = 2 * pairs;
+  return inside + sampleScalar(seed, first + vector_samples,
+                               count - vector_samples, grid,
+                               out + vector_samples);
+#else
+  return sampleScalar(seed, first, count, grid, out);
+#endif
+}
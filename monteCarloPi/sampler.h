@@ -0,0 +1,83 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Batched Monte Carlo sampling kernel.
+ *
+ * Random numbers come from Philox4x32-10, a counter based generator: sample i
+ * of a stream is a pure function of (seed, i). One Philox block gives the
+ * x and y coordinates of two samples. Because nothing is carried between
+ * calls, any range of samples can be generated in any order (or by any
+ * thread) and the result is the same.
+ *
+ * The kernel is picked at compile time: AVX2 (8 Philox lanes), SSE2 or wasm
+ * simd128 (4 lanes), or a scalar fallback. All of them use the same float
+ * arithmetic, so every backend produces identical samples.
+ *
+ * Besides plain pseudo random sampling there are quasi Monte Carlo and
+ * variance reduction modes. The stream is cut into replicates of
+ * SAMPLE_REPLICATE samples, each replicate is an independently randomized
+ * point set (digitally shifted Sobol net, randomly shifted Halton points, one
+ * jittered point per stratum, antithetic pairs), so the spread of the
+ * replicate estimates gives a standard error for every mode. These modes work
+ * on the quarter circle in [0,1)^2 and mirror each point into a random
+ * quadrant for display, the antithetic pairs need it to be negatively
+ * correlated.
+ */
+
+// Pixel grid samples are plotted on
+struct SampleGrid {
+  uint32_t w;
+  uint32_t h;
+  uint32_t pitch;
+  uint32_t bytes; // Bytes per pixel
+};
+
+// Set in a sample word when the point is inside the unit circle, the
+// remaining bits are the pixel byte offset in the grid.
+const uint32_t SAMPLE_INSIDE = 0x80000000u;
+const uint32_t SAMPLE_INDEX = ~SAMPLE_INSIDE;
+
+// Philox4x32 round multipliers and key increments
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+const int PHILOX_ROUNDS = 10;
+
+// 2^-24, turns the top 24 bits of a word into a float in [0.0,1.0)
+const float SAMPLE_UNIT = 1.0F / 16777216.0F;
+
+// Name of the kernel that was compiled in
+extern const char *const SAMPLER_KERNEL;
+
+enum SampleMode {
+  SAMPLE_RANDOM,     // Philox points, vectorized
+  SAMPLE_SOBOL,      // Sobol (0,m,2)-nets, digitally shifted per replicate
+  SAMPLE_HALTON,     // Halton bases 2 and 3, randomly shifted per replicate
+  SAMPLE_STRATIFIED, // One jittered point per cell of a 64x64 grid
+  SAMPLE_ANTITHETIC, // Philox points paired with their reflection
+  SAMPLE_MODES
+};
+extern const char *const SAMPLE_MODE_NAMES[SAMPLE_MODES];
+// Looks up a mode by name, returns SAMPLE_MODES if there is none
+SampleMode sampleModeByName(const char *name);
+
+// Samples per replicate, a power of two and a multiple of 64*64 strata
+const uint64_t SAMPLE_REPLICATE = 4096;
+
+// One Philox4x32-10 block for counter ctr under a 64-bit key
+void philox4x32(const uint32_t ctr[4], uint64_t key, uint32_t out[4]);
+
+/* sampleBatch(mode, seed, first, count, grid, out) -> inside count
+ * Generates samples first .. first + count - 1 of the stream given by mode
+ * and seed and writes one sample word per sample to out. Returns how many of
+ * them are inside the unit circle.
+ */
+uint64_t sampleBatch(SampleMode mode, uint64_t seed, uint64_t first,
+                     size_t count, const SampleGrid &grid, uint32_t *out);
+
+#endif
@@ -0,0 +1,140 @@
+#include "sampler_pool.h"
+#include <algorithm>
+
+// Batches below this are cheaper to generate inline than to hand off
+static const size_t MIN_PARALLEL_SAMPLES = 1 << 14;
+
+void SamplerPool::start(unsigned workers, size_t capacity) {
+  stop();
+  if (workers == 0) {
+    unsigned hw = std::thread::hardware_concurrency();
+    // Leave one hardware thread to the renderer
+    workers = hw > 1 ? hw - 1 : 1;
+  }
+  quit = false;
+  slots.assign(workers, Slot());
+  for (SampleBlock &b : blocks) {
+    b.samples.reserve(capacity);
+    b.replicate_inside.reserve(capacity / SAMPLE_REPLICATE + 2);
+  }
+#if SAMPLER_POOL_THREADS
+  for (unsigned id = 0; id < workers; id++)
+    threads.emplace_back(&SamplerPool::work, this, id, generation);
+#endif
+}
+
+void SamplerPool::stop() {
+  if (in_flight)
+    collect();
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    quit = true;
+  }
+  work_ready.notify_all();
+  for (std::thread &t : threads)
+    t.join();
+  threads.clear();
+}
+
+// Generates samples [begin, end) of the back block one replicate at a time
+// and counts each replicate, returns the inside count of the range
+uint64_t SamplerPool::generate(size_t begin, size_t end) {
+  SampleBlock &b = blocks[back];
+  const uint64_t first_replicate = b.first / SAMPLE_REPLICATE;
+  uint64_t inside = 0;
+  for (size_t k = begin; k < end;) {
+    const uint64_t i = b.first + k;
+    const size_t take = static_cast<size_t>(std::min<uint64_t>(
+        SAMPLE_REPLICATE - i % SAMPLE_REPLICATE, end - k));
+    const uint64_t c =
+        sampleBatch(mode, seed, i, take, grid, b.samples.data() + k);
+    b.replicate_inside[i / SAMPLE_REPLICATE - first_replicate] =
+        static_cast<uint32_t>(c);
+    inside += c;
+    k += take;
+  }
+  return inside;
+}
+
+// Generates the part of the back block that belongs to worker id. Slices
+// start on a replicate, so no two workers count the same one.
+void SamplerPool::runSlice(unsigned id) {
+  const SampleBlock &b = blocks[back];
+  const size_t count = b.samples.size();
+  const size_t n = slots.size();
+  auto boundary = [&](size_t k) {
+    if (k == 0)
+      return static_cast<size_t>(0);
+    uint64_t i = b.first + count * k / n;
+    i = (i + SAMPLE_REPLICATE - 1) / SAMPLE_REPLICATE * SAMPLE_REPLICATE;
+    return static_cast<size_t>(std::min<uint64_t>(i - b.first, count));
+  };
+  slots[id].inside = generate(boundary(id), boundary(id + 1));
+}
+
+// seen is the generation at start, the worker waits for the next one
+void SamplerPool::work(unsigned id, uint64_t seen) {
+  std::unique_lock<std::mutex> guard(lock);
+  while (true) {
+    work_ready.wait(guard, [&] { return quit || generation != seen; });
+    if (quit)
+      return;
+    seen = generation;
+    guard.unlock();
+    runSlice(id);
+    guard.lock();
+    if (--busy == 0)
+      work_done.notify_one();
+  }
+}
+
+void SamplerPool::submit(SampleMode mode, uint64_t seed, uint64_t first,
+                         size_t count, const SampleGrid &grid) {
+  if (in_flight)
+    collect();
+  SampleBlock &b = blocks[back];
+  b.samples.resize(count);
+  const uint64_t last = first + count - 1;
+  b.replicate_inside.assign(
+      count ? last / SAMPLE_REPLICATE - first / SAMPLE_REPLICATE + 1 : 0, 0);
+  b.first = first;
+  b.inside = 0;
+  in_flight = true;
+  this->mode = mode;
+  this->seed = seed;
+  this->grid = grid;
+  if (!SAMPLER_POOL_THREADS || threads.empty() || count < MIN_PARALLEL_SAMPLES) {
+    b.inside = generate(0, count);
+    std::fill(slots.begin(), slots.end(), Slot());
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    busy = static_cast<unsigned>(threads.size());
+    generation++;
+  }
+  work_ready.notify_all();
+}
+
+const SampleBlock &SamplerPool::collect() {
+  if (!in_flight) {
+    // Nothing submitted, hand out an empty block
+    blocks[back ^ 1].samples.clear();
+    blocks[back ^ 1].replicate_inside.clear();
+    blocks[back ^ 1].inside = 0;
+    return blocks[back ^ 1];
+  }
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    work_done.wait(guard, [&] { return busy == 0; });
+  }
+  SampleBlock &b = blocks[back];
+  // Reduce the private counters of the workers
+  for (Slot &s : slots) {
+    b.inside += s.inside;
+    s.inside = 0;
+  }
+  in_flight = false;
+  back ^= 1;
+  return b;
+}
@@ -0,0 +1,87 @@
+#ifndef SAMPLER_POOL_H
+#define SAMPLER_POOL_H
+
+#include "sampler.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Without pthreads (plain Emscripten build) batches run on the calling thread
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define SAMPLER_POOL_THREADS 0
+#else
+#define SAMPLER_POOL_THREADS 1
+#endif
+
+// A finished batch of samples
+struct SampleBlock {
+  std::vector<uint32_t> samples; // Sample words in stream order
+  uint64_t first = 0;            // Stream index of samples[0]
+  uint64_t inside = 0;           // Samples inside the unit circle
+  // Inside count per replicate the block touches, from the replicate of
+  // first on. The first and the last one may be partial.
+  std::vector<uint32_t> replicate_inside;
+};
+
+/*
+ * Worker pool for sampleBatch. Batches are double buffered: submit() hands
+ * the back block to the workers and returns at once, collect() waits for it
+ * and swaps it to the front, so the render thread can draw one batch while
+ * the next one is generated.
+ *
+ * A batch is split into one contiguous slice of the sample stream per
+ * worker, cut on replicate boundaries. Every worker writes its own part of
+ * the block and the inside counts of its replicates, and keeps a private
+ * inside count which collect() reduces. Samples are addressed by stream
+ * index, so the block is the same for any number of workers.
+ */
+class SamplerPool {
+public:
+  SamplerPool() = default;
+  SamplerPool(const SamplerPool &) = delete;
+  SamplerPool &operator=(const SamplerPool &) = delete;
+  ~SamplerPool() { stop(); }
+
+  // Starts the workers, 0 picks one per spare hardware thread
+  void start(unsigned workers = 0, size_t capacity = 0);
+  void stop();
+  unsigned workers() const { return static_cast<unsigned>(slots.size()); }
+
+  // Starts generating samples first .. first + count - 1 into the back block
+  void submit(SampleMode mode, uint64_t seed, uint64_t first, size_t count,
+              const SampleGrid &grid);
+  // True if a batch has been submitted and not collected yet
+  bool pending() const { return in_flight; }
+  // Waits for the submitted batch and returns it. Without a batch in flight
+  // an empty block is returned. The block stays valid until the next collect.
+  const SampleBlock &collect();
+
+private:
+  struct alignas(64) Slot {
+    uint64_t inside = 0;
+  };
+  void work(unsigned id, uint64_t seen);
+  void runSlice(unsigned id);
+  uint64_t generate(size_t begin, size_t end);
+
+  std::vector<Slot> slots;
+  std::vector<std::thread> threads;
+  SampleBlock blocks[2];
+  int back = 0;
+  bool in_flight = false;
+
+  // Batch description, written by submit() under the lock
+  SampleMode mode = SAMPLE_RANDOM;
+  uint64_t seed = 0;
+  SampleGrid grid = {};
+  std::mutex lock;
+  std::condition_variable work_ready;
+  std::condition_variable work_done;
+  uint64_t generation = 0;
+  unsigned busy = 0;
+  bool quit = false;
+};
+
+#endif
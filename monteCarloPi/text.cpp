@@ -0,0 +1,123 @@
+#include "text.h"
+#include <algorithm>
+#include <cstdio>
+
+// Glyphs are packed in rows no wider than this
+static const int ATLAS_WIDTH = 512;
+// Atlas glyphs are white and tinted with the color mod when drawn
+static const SDL_Color WHITE = {255, 255, 255, 255};
+
+bool GlyphAtlas::build(SDL_Renderer *renderer, TTF_Font *font) {
+  destroy();
+  SDL_Surface *surfaces[GLYPH_COUNT] = {};
+  // Lay out the glyphs row by row
+  int x = 0, y = 0, row_h = 0;
+  bool ok = true;
+  for (int i = 0; i < GLYPH_COUNT && ok; i++) {
+    Uint16 ch = static_cast<Uint16>(GLYPH_FIRST + i);
+    int minx, maxx, miny, maxy;
+    if (TTF_GlyphMetrics(font, ch, &minx, &maxx, &miny, &maxy,
+                         &advance[i]) < 0) {
+      advance[i] = 0;
+      continue;
+    }
+    surfaces[i] = TTF_RenderGlyph_Blended(font, ch, WHITE);
+    if (!surfaces[i]) // Blank glyphs such as space render nothing
+      continue;
+    if (x + surfaces[i]->w > ATLAS_WIDTH) {
+      x = 0;
+      y += row_h;
+      row_h = 0;
+    }
+    glyphs[i] = {x, y, surfaces[i]->w, surfaces[i]->h};
+    x += surfaces[i]->w;
+    row_h = std::max(row_h, surfaces[i]->h);
+  }
+  height = TTF_FontHeight(font);
+
+  SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(
+      0, ATLAS_WIDTH, std::max(y + row_h, 1), 32, SDL_PIXELFORMAT_ARGB8888);
+  if (!atlas) {
+    printf("Glyph atlas could not be created! SDL Error: %s\n",
+           SDL_GetError());
+    ok = false;
+  }
+  for (int i = 0; i < GLYPH_COUNT; i++) {
+    if (!surfaces[i])
+      continue;
+    if (ok) {
+      // Copy the alpha channel as is instead of blending onto the atlas
+      SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(surfaces[i], NULL, atlas, &glyphs[i]);
+    }
+    SDL_FreeSurface(surfaces[i]);
+  }
+  if (ok) {
+    texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    if (!texture) {
+      printf("Glyph atlas texture could not be created! SDL Error: %s\n",
+             SDL_GetError());
+      ok = false;
+    } else {
+      SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+  }
+  SDL_FreeSurface(atlas);
+  return ok;
+}
+
+void GlyphAtlas::destroy() {
+  if (texture)
+    SDL_DestroyTexture(texture);
+  texture = nullptr;
+}
+
+int GlyphAtlas::draw(SDL_Renderer *renderer, const char *txt, int x, int y,
+                     const SDL_Color &color) const {
+  SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+  SDL_SetTextureAlphaMod(texture, color.a);
+  for (const char *c = txt; *c; c++) {
+    int i = static_cast<unsigned char>(*c) - GLYPH_FIRST;
+    if (i < 0 || i >= GLYPH_COUNT)
+      i = '?' - GLYPH_FIRST;
+    const SDL_Rect &src = glyphs[i];
+    if (src.w > 0) {
+      SDL_Rect dst = {x, y, src.w, src.h};
+      SDL_RenderCopy(renderer, texture, &src, &dst);
+    }
+    x += advance[i];
+  }
+  return x;
+}
+
+bool TextLabel::build(SDL_Renderer *renderer, TTF_Font *font, const char *txt,
+                      const SDL_Color &color) {
+  destroy();
+  SDL_Surface *surface = TTF_RenderText_Blended(font, txt, color);
+  if (!surface) {
+    printf("Label could not be rendered: %s\n", TTF_GetError());
+    return false;
+  }
+  texture = SDL_CreateTextureFromSurface(renderer, surface);
+  w = surface->w;
+  h = surface->h;
+  SDL_FreeSurface(surface);
+  if (!texture) {
+    printf("Label texture could not be created! SDL Error: %s\n",
+           SDL_GetError());
+    return false;
+  }
+  return true;
+}
+
+void TextLabel::destroy() {
+  if (texture)
+    SDL_DestroyTexture(texture);
+  texture = nullptr;
+}
+
+int TextLabel::draw(SDL_Renderer *renderer, int x, int y) const {
+  SDL_Rect dst = {x, y, w, h};
+  SDL_RenderCopy(renderer, texture, NULL, &dst);
+  return x + w;
+}
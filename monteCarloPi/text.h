@@ -0,0 +1,45 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+/*
+ * Text drawn from textures that are rasterized once at startup. Static
+ * strings are kept as whole TextLabels, strings that change every frame are
+ * composed glyph by glyph from a GlyphAtlas with SDL_RenderCopy, which SDL
+ * batches into a few draw calls.
+ */
+
+// First and last character in the atlas, printable ASCII
+const int GLYPH_FIRST = 32;
+const int GLYPH_LAST = 126;
+const int GLYPH_COUNT = GLYPH_LAST - GLYPH_FIRST + 1;
+
+struct GlyphAtlas {
+  SDL_Texture *texture = nullptr;
+  SDL_Rect glyphs[GLYPH_COUNT] = {}; // Source rect of each glyph
+  int advance[GLYPH_COUNT] = {};
+  int height = 0;
+
+  // Rasterizes every glyph of font into one texture, false on error
+  bool build(SDL_Renderer *renderer, TTF_Font *font);
+  void destroy();
+  // Draws txt with its top left corner at x,y and returns the x after it
+  int draw(SDL_Renderer *renderer, const char *txt, int x, int y,
+           const SDL_Color &color) const;
+};
+
+struct TextLabel {
+  SDL_Texture *texture = nullptr;
+  int w = 0;
+  int h = 0;
+
+  bool build(SDL_Renderer *renderer, TTF_Font *font, const char *txt,
+             const SDL_Color &color);
+  void destroy();
+  // Draws the label with its top left corner at x,y and returns the x after it
+  int draw(SDL_Renderer *renderer, int x, int y) const;
+};
+
+#endif